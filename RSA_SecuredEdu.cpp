@@ -4,22 +4,85 @@
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
+#include <climits>
+#ifdef _WIN32
+#include <winsock2.h>   // must come before windows.h
+#endif
 #include <windows.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
 #include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <sstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSV_USE_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSV_USE_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace std;
 
 //  CONSTANTS 
-const int MAX_USERS = 100;
-const int MAX_CLASSES = 50;
-const int MAX_EXAMS = 50;
-const int MAX_ASSIGNMENTS = 100;
-const int MAX_messagesList = 100;
-const int MAX_REQUESTS = 100;
-const int MAX_KEYS = 100;
+const int TABLE_CHUNK = 64;   // records per allocation in the growable tables
 const int BOX_WIDTH = 60;
 
+// Keys are built from primes below 500, so every modulus is below
+// MAX_MODULUS and encryptMessage() writes each character as a "%lld " token
+// of at most CIPHER_TOKEN_CHARS. A ciphertext buffer of a given size holds
+// cipherCapacity() characters of plaintext; keys with a larger n are refused.
+const long long MAX_MODULUS = 250000;
+const int CIPHER_TOKEN_CHARS = 7;
+
+constexpr int cipherCapacity(size_t bufferBytes) { return (int)(bufferBytes - 1) / CIPHER_TOKEN_CHARS; }
+
 //  STRUCTURES
+// Usernames and record ids are held as interned Symbols (see SYMBOL TABLE);
+// they are turned back into strings only when rows are written to disk or shown.
+typedef int Symbol;
+const Symbol NO_SYMBOL = -1;
+
+// Compressed set of Symbols (see SYMBOL SETS). Symbols are grouped by their
+// high 16 bits; each group is a sorted array of low halves while sparse and a
+// 65536-bit bitmap once dense.
+struct SetContainer {
+    unsigned short key;                 // high 16 bits
+    vector<unsigned short> values;      // sorted low halves, while sparse
+    vector<unsigned long long> bits;    // 1024 words, once dense
+    int cardinality;
+};
+
+struct SymbolSet {
+    vector<SetContainer> containers;    // sorted by key
+};
+
 struct RSAKeys {
     long long n;
     long long e;
@@ -30,13 +93,13 @@ struct RSAKeys {
 };
 
 struct DigitalSignature {
-    char signedBy[50];
+    Symbol signedBy;
     long long signatureHash;
     bool isVerified;
 };
 
 struct User {
-    char username[50];
+    Symbol username;
     char password[50];
     char role[20];
     RSAKeys keys;
@@ -44,29 +107,36 @@ struct User {
 };
 
 struct Classroom {
-    char classId[20];
+    Symbol classId;
     char className[100];
     char classCode[10];
-    char teacherName[50];
-    char enrolledStudents[50][50];
-    int studentCount;
-    char assignedExams[20][20];
-    int examCount;
+    Symbol teacherName;
+    vector<Symbol> enrolledStudents;
+    vector<Symbol> assignedExams;
     bool isActive;
 };
 
+// Exams and assignments are split into a hot part, which listings and
+// filters scan, and a cold payload holding text, ciphertext, signature and
+// keys. The payload lives in its own table at the same row index, so a scan
+// over the hot table strides a few dozen bytes per row instead of ~5 KB, and
+// only rows that pass the filter touch their payload.
 struct Exam {
-    char id[20];
-    char title[100];
-    char encryptedContent[5000];
-    char teacherName[50];
-    char assignedClassId[20];
-    char assignedClassName[100];
-    int duration;
+    Symbol id;
+    Symbol teacherName;
+    Symbol assignedClassId;
+    int duration;         // minutes per attempt
+    long long opensAt;    // release time, 0 = on creation
+    long long closesAt;   // close time, 0 = never
     bool isActive;
-    char approvedStudents[50][50];
-    int approvedCount;
     bool keyDistributed;
+    SymbolSet approvedStudents;
+};
+
+struct ExamPayload {
+    char title[100];
+    char assignedClassName[100];
+    char encryptedContent[5000];
     DigitalSignature signature;  //  digital signature
   
     long long exam_n; // Unique Modulus for this exam
@@ -77,69 +147,919 @@ struct Exam {
 };
 
 struct Assignment {
-    char id[20];
-    char studentName[50];
-    char courseName[100];
+    Symbol id;
+    Symbol studentName;
+    Symbol courseName;  // exam id
+    bool isGraded;
+};
+
+struct AssignmentPayload {
     char encryptedSubmission[5000];
     char encryptedGrade[1000];
-    bool isGraded;
     DigitalSignature signature;  // Added digital signature
 };
 
 struct Message {
-    char id[20];
-    char from[50];
-    char to[50];
+    Symbol id;
+    Symbol from;
+    Symbol to;
     char encryptedContent[2000];
     bool isRead;
     long long integrityHash;  // Added for integrity check
 };
 
 struct AccessRequest {
-    char id[20];
-    char studentName[50];
-    char examId[20];
+    Symbol id;
+    Symbol studentName;
+    Symbol examId;
     char examTitle[100];
-    char teacherName[50];
-    char classId[20];
+    Symbol teacherName;
+    Symbol classId;
     char status[20];
     char message[500];
 };
 
 struct KeyDistribution {
-    char id[20];
-    char examId[20];
+    Symbol id;
+    Symbol examId;
     char examTitle[100];
-    char classId[20];
+    Symbol classId;
     char className[100];
-    char fromTeacher[50];
-    char toStudent[50];
+    Symbol fromTeacher;
+    Symbol toStudent;   // "CLASS" for class-wide keys
     long long publicKeyE;
-    long long publicKeyN;
-    long long p; // Prime P (for student cracking)
-    long long q; // Prime Q (for student cracking)
+    long long publicKeyN;   // the private key reaches students in envelopes
     bool isClassWide;
-    bool isRead;
+    SymbolSet readers;  // students who have opened this key
 };
 
+//  GROWABLE TABLES
+// Records are stored in chunks of TABLE_CHUNK that are allocated only when the
+// table grows past them, so memory follows the live record count. Chunks never
+// move, so a row index (and a reference to a row) stays valid as rows are added.
+// A deleted row is marked dead and pushed on the free list, and the next insert
+// takes it back; compactRows() squeezes the holes out when they pile up.
+template <typename T>
+struct ChunkedTable {
+    vector<T*> chunks;
+    vector<unsigned char> dead;   // 1 for a deleted row, indexed by row
+    vector<int> freeRows;         // dead rows ready for reuse
+
+    T& operator[](int row) { return chunks[row / TABLE_CHUNK][row % TABLE_CHUNK]; }
+    const T& operator[](int row) const { return chunks[row / TABLE_CHUNK][row % TABLE_CHUNK]; }
+
+    // Returns row, allocating its chunk first if needed.
+    T& ensure(int row) {
+        while ((int)chunks.size() * TABLE_CHUNK <= row) chunks.push_back(new T[TABLE_CHUNK]());
+        return (*this)[row];
+    }
+
+    bool isLive(int row) const { return row >= (int)dead.size() || !dead[row]; }
+};
+
+// Returns a cleared row for a new record: a freed one if any, else the next
+// row past count.
+template <typename T>
+int allocRow(ChunkedTable<T>& table, int& count) {
+    int row;
+    if (!table.freeRows.empty()) {
+        row = table.freeRows.back();
+        table.freeRows.pop_back();
+        table.dead[row] = 0;
+    } else {
+        row = count++;
+        table.ensure(row);
+    }
+    table[row] = T();
+    return row;
+}
+
+template <typename T>
+void freeRow(ChunkedTable<T>& table, int row) {
+    table[row] = T();
+    if ((int)table.dead.size() <= row) table.dead.resize(row + 1, 0);
+    table.dead[row] = 1;
+    table.freeRows.push_back(row);
+}
+
+template <typename T>
+void clearRows(ChunkedTable<T>& table) {
+    table.dead.clear();
+    table.freeRows.clear();
+}
+
+template <typename T>
+int liveRows(const ChunkedTable<T>& table, int count) {
+    return count - (int)table.freeRows.size();
+}
+
 //  GLOBAL ARRAYS 
-User users[MAX_USERS];
+ChunkedTable<User> users;
 int userCount = 0;
-Classroom classes[MAX_CLASSES];
+ChunkedTable<Classroom> classes;
 int classCount = 0;
-Exam exams[MAX_EXAMS];
+ChunkedTable<Exam> exams;
+ChunkedTable<ExamPayload> examPayloads;
 int examCount = 0;
-Assignment assignments[MAX_ASSIGNMENTS];
+ChunkedTable<Assignment> assignments;
+ChunkedTable<AssignmentPayload> assignmentPayloads;
 int assignmentCount = 0;
-Message messagesList[MAX_messagesList];
+ChunkedTable<Message> messagesList;
 int messageCount = 0;
-AccessRequest requests[MAX_REQUESTS];
+ChunkedTable<AccessRequest> requests;
 int requestCount = 0;
-KeyDistribution keyDist[MAX_KEYS];
+ChunkedTable<KeyDistribution> keyDist;
 int keyDistCount = 0;
 
+//  TABLE LOCKS
+// One reader-writer lock per table. Code that changes a table holds its lock
+// exclusively and code that only reads holds it shared, so listings for many
+// sessions run side by side and only wait while a writer is inside. The
+// lock covers the table's row indexes and views as well. An operation takes
+// a TableGuard over a mask of tables it reads and writes; the guard locks in
+// bit order, so two operations can never wait on each other. Helpers below
+// an operation (save*(), rebuildIndexes(), the index updates) never lock;
+// the caller already holds what they touch. Locks are not re-entrant.
+#ifdef _WIN32
+typedef SRWLOCK RWLock;
+#define RWLOCK_INIT SRWLOCK_INIT
+bool rwTryRead(RWLock& lock) { return TryAcquireSRWLockShared(&lock) != 0; }
+bool rwTryWrite(RWLock& lock) { return TryAcquireSRWLockExclusive(&lock) != 0; }
+void rwRead(RWLock& lock) { AcquireSRWLockShared(&lock); }
+void rwWrite(RWLock& lock) { AcquireSRWLockExclusive(&lock); }
+void rwReadUnlock(RWLock& lock) { ReleaseSRWLockShared(&lock); }
+void rwWriteUnlock(RWLock& lock) { ReleaseSRWLockExclusive(&lock); }
+#else
+typedef pthread_rwlock_t RWLock;
+#define RWLOCK_INIT PTHREAD_RWLOCK_INITIALIZER
+bool rwTryRead(RWLock& lock) { return pthread_rwlock_tryrdlock(&lock) == 0; }
+bool rwTryWrite(RWLock& lock) { return pthread_rwlock_trywrlock(&lock) == 0; }
+void rwRead(RWLock& lock) { pthread_rwlock_rdlock(&lock); }
+void rwWrite(RWLock& lock) { pthread_rwlock_wrlock(&lock); }
+void rwReadUnlock(RWLock& lock) { pthread_rwlock_unlock(&lock); }
+void rwWriteUnlock(RWLock& lock) { pthread_rwlock_unlock(&lock); }
+#endif
+
+enum TableBit {
+    TABLE_USERS = 1,
+    TABLE_CLASSES = 2,
+    TABLE_EXAMS = 4,          // exams[] and examPayloads[]
+    TABLE_ASSIGNMENTS = 8,    // assignments[] and assignmentPayloads[]
+    TABLE_KEYDIST = 16,
+    TABLE_MESSAGES = 32,
+    TABLE_REQUESTS = 64,
+    TABLE_ALL = 127
+};
+const int TABLE_LOCK_COUNT = 7;
+const char* TABLE_LOCK_NAMES[TABLE_LOCK_COUNT] = {"Users", "Classes", "Exams", "Submissions", "Key dists", "Messages", "Requests"};
+
+RWLock tableLocks[TABLE_LOCK_COUNT] = {RWLOCK_INIT, RWLOCK_INIT, RWLOCK_INIT, RWLOCK_INIT, RWLOCK_INIT, RWLOCK_INIT, RWLOCK_INIT};
+atomic<long long> lockAcquires[TABLE_LOCK_COUNT];
+atomic<long long> lockWaits[TABLE_LOCK_COUNT];   // acquires that found the lock taken
+
+struct TableGuard {
+    int readMask;
+    int writeMask;
+
+    TableGuard(int reads, int writes) : readMask(reads & ~writes), writeMask(writes) {
+        for (int t = 0; t < TABLE_LOCK_COUNT; t++) {
+            bool write = (writeMask >> t) & 1;
+            if (!write && !((readMask >> t) & 1)) continue;
+            lockAcquires[t]++;
+            if (write ? rwTryWrite(tableLocks[t]) : rwTryRead(tableLocks[t])) continue;
+            lockWaits[t]++;
+            if (write) rwWrite(tableLocks[t]);
+            else rwRead(tableLocks[t]);
+        }
+    }
+
+    ~TableGuard() {
+        for (int t = TABLE_LOCK_COUNT - 1; t >= 0; t--) {
+            if ((writeMask >> t) & 1) rwWriteUnlock(tableLocks[t]);
+            else if ((readMask >> t) & 1) rwReadUnlock(tableLocks[t]);
+        }
+    }
+};
+
+//  THREADS
+// Win32 threads, mutexes and condition variables, with pthreads elsewhere.
+// All of them can be initialised statically.
+#ifdef _WIN32
+typedef HANDLE ThreadHandle;
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE Condition;
+typedef DWORD (WINAPI *ThreadMain)(LPVOID);
+#define THREAD_MAIN(name) DWORD WINAPI name(LPVOID arg)
+#define MUTEX_INIT SRWLOCK_INIT
+#define CONDITION_INIT CONDITION_VARIABLE_INIT
+void mutexInit(Mutex& m) { InitializeSRWLock(&m); }
+void mutexLock(Mutex& m) { AcquireSRWLockExclusive(&m); }
+void mutexUnlock(Mutex& m) { ReleaseSRWLockExclusive(&m); }
+void conditionWait(Condition& c, Mutex& m, int ms) { SleepConditionVariableSRW(&c, &m, ms, 0); }
+void conditionWakeAll(Condition& c) { WakeAllConditionVariable(&c); }
+bool startThread(ThreadHandle& thread, ThreadMain main, void* arg) {
+    thread = CreateThread(NULL, 0, main, arg, 0, NULL);
+    return thread != NULL;
+}
+void joinThread(ThreadHandle thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+int cpuCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+long long monotonicMs() { return (long long)GetTickCount64(); }
+#else
+typedef pthread_t ThreadHandle;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+typedef void* (*ThreadMain)(void*);
+#define THREAD_MAIN(name) void* name(void* arg)
+#define MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define CONDITION_INIT PTHREAD_COND_INITIALIZER
+void mutexInit(Mutex& m) { pthread_mutex_init(&m, NULL); }
+void mutexLock(Mutex& m) { pthread_mutex_lock(&m); }
+void mutexUnlock(Mutex& m) { pthread_mutex_unlock(&m); }
+void conditionWait(Condition& c, Mutex& m, int ms) {
+    timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += ms / 1000;
+    until.tv_nsec += (ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&c, &m, &until);
+}
+void conditionWakeAll(Condition& c) { pthread_cond_broadcast(&c); }
+bool startThread(ThreadHandle& thread, ThreadMain main, void* arg) {
+    return pthread_create(&thread, NULL, main, arg) == 0;
+}
+void joinThread(ThreadHandle thread) { pthread_join(thread, NULL); }
+int cpuCount() { return (int)sysconf(_SC_NPROCESSORS_ONLN); }
+long long monotonicMs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+#endif
+
+//  LATENCY HISTOGRAMS
+// Bucket b counts latencies below 2^b ms, so a percentile is an upper bound
+// good to a factor of two. Any thread may record while another reads.
+const int LATENCY_BUCKETS = 24;
+
+struct LatencyHistogram {
+    atomic<long long> buckets[LATENCY_BUCKETS];
+    LatencyHistogram() { for (int b = 0; b < LATENCY_BUCKETS; b++) buckets[b] = 0; }
+};
+
+void recordLatency(LatencyHistogram& histogram, long long ms) {
+    int b = 0;
+    while (b < LATENCY_BUCKETS - 1 && (1LL << b) <= ms) b++;
+    histogram.buckets[b]++;
+}
+
+// Upper bound in ms of the given percentile.
+long long latencyPercentile(const LatencyHistogram& histogram, double percent) {
+    long long counts[LATENCY_BUCKETS], total = 0, seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) total += counts[b] = histogram.buckets[b];
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += counts[b];
+        if (total > 0 && seen * 100.0 >= total * percent) return 1LL << b;
+    }
+    return 0;
+}
+
+//  EXECUTOR
+// A process-wide pool with one worker per core. Each worker owns a deque per
+// priority: it runs its own newest task first and, when it has none, steals
+// the oldest task of another worker. Interactive tasks are always taken
+// before bulk ones. A thread waiting on a TaskGroup runs queued tasks of
+// that group meanwhile, so tasks may submit and wait on more tasks. It never
+// runs anyone else's task: callers wait while holding TableGuards, and an
+// unrelated task (an OPEN ticket, say) would take locks under them. Before
+// the pool is started everything runs inline on the caller.
+enum TaskPriority { PRIORITY_INTERACTIVE = 0, PRIORITY_BULK = 1 };
+const int TASK_PRIORITIES = 2;
+const int MAX_WORKERS = 16;
+
+typedef void (*TaskFn)(void* arg, int begin, int end);
+
+// Queued tasks of a cancelled group are dropped; running ones may poll it.
+struct CancelToken {
+    atomic<bool> cancelled;
+    CancelToken() : cancelled(false) {}
+};
+
+struct TaskGroup {
+    atomic<int> pending;
+    CancelToken* cancel;
+    TaskGroup(CancelToken* token) : pending(0), cancel(token) {}
+};
+
+struct Task {
+    TaskFn fn;
+    void* arg;
+    int begin, end;
+    TaskGroup* group;
+};
+
+struct Worker {
+    Mutex lock;
+    deque<Task> tasks[TASK_PRIORITIES];
+    atomic<long long> executed;
+    atomic<long long> stolen;    // tasks taken from another worker's deque
+    ThreadHandle thread;
+};
+
+Worker workers[MAX_WORKERS];
+int workerCount = 0;
+thread_local int currentWorker = -1;
+atomic<unsigned> nextWorker(0);
+atomic<int> queuedTasks(0);
+atomic<int> maxQueuedTasks(0);
+atomic<long long> helperTasks(0);   // tasks run by waiting threads outside the pool
+Mutex executorMutex = MUTEX_INIT;
+Condition workAvailable = CONDITION_INIT;
+Condition groupFinished = CONDITION_INIT;
+bool executorStop = false;
+
+bool isCancelled(const CancelToken* token) { return token != NULL && token->cancelled; }
+
+void runTask(const Task& task) {
+    TaskGroup* group = task.group;
+    if (!isCancelled(group->cancel)) task.fn(task.arg, task.begin, task.end);
+    if (--group->pending == 0) {
+        mutexLock(executorMutex);
+        conditionWakeAll(groupFinished);
+        mutexUnlock(executorMutex);
+    }
+}
+
+// Queues a task without waking anyone; see wakeWorkers().
+void pushTask(const Task& task, TaskPriority priority) {
+    task.group->pending++;
+    int depth = ++queuedTasks;
+    int seen = maxQueuedTasks;
+    while (depth > seen && !maxQueuedTasks.compare_exchange_weak(seen, depth)) {}
+    int w = currentWorker >= 0 ? currentWorker : (int)(nextWorker++ % workerCount);
+    mutexLock(workers[w].lock);
+    workers[w].tasks[priority].push_back(task);
+    mutexUnlock(workers[w].lock);
+}
+
+void wakeWorkers() {
+    mutexLock(executorMutex);
+    conditionWakeAll(workAvailable);
+    mutexUnlock(executorMutex);
+}
+
+// Takes the highest-priority task available to worker self (-1 for threads
+// outside the pool): newest from its own deque, otherwise oldest from another.
+// With only set, just tasks of that group are taken.
+bool takeTask(int self, Task& task, const TaskGroup* only = NULL) {
+    if (queuedTasks <= 0) return false;
+    for (int p = 0; p < TASK_PRIORITIES; p++) {
+        for (int k = 0; k < workerCount; k++) {
+            int w = self >= 0 ? (self + k) % workerCount : k;
+            mutexLock(workers[w].lock);
+            deque<Task>& tasks = workers[w].tasks[p];
+            int size = (int)tasks.size();
+            int found = -1;
+            for (int i = 0; i < size && found == -1; i++) {
+                int at = w == self ? size - 1 - i : i;
+                if (only == NULL || tasks[at].group == only) found = at;
+            }
+            if (found != -1) {
+                task = tasks[found];
+                tasks.erase(tasks.begin() + found);
+            }
+            mutexUnlock(workers[w].lock);
+            if (found == -1) continue;
+            queuedTasks--;
+            if (self < 0) helperTasks++;
+            else {
+                workers[self].executed++;
+                if (w != self) workers[self].stolen++;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void waitGroup(TaskGroup& group) {
+    Task task;
+    while (group.pending > 0) {
+        if (takeTask(currentWorker, task, &group)) {
+            runTask(task);
+            continue;
+        }
+        mutexLock(executorMutex);
+        if (group.pending > 0) conditionWait(groupFinished, executorMutex, 10);
+        mutexUnlock(executorMutex);
+    }
+}
+
+// Runs fn over [begin, end) in chunks of at most grain items and returns when
+// all of them are done. The caller runs the first chunk itself.
+void parallelFor(int begin, int end, int grain, TaskFn fn, void* arg,
+                 TaskPriority priority, CancelToken* cancel = NULL) {
+    if (end - begin <= grain || workerCount == 0) {
+        if (begin < end && !isCancelled(cancel)) fn(arg, begin, end);
+        return;
+    }
+    TaskGroup group(cancel);
+    for (int start = begin + grain; start < end; start += grain) {
+        Task task = {fn, arg, start, min(start + grain, end), &group};
+        pushTask(task, priority);
+    }
+    wakeWorkers();
+    if (!isCancelled(cancel)) fn(arg, begin, begin + grain);
+    waitGroup(group);
+}
+
+// Tasks nobody waits on; stopExecutor() lets them finish.
+TaskGroup backgroundTasks(NULL);
+
+void runAsync(TaskFn fn, void* arg, TaskPriority priority) {
+    if (workerCount == 0) {
+        fn(arg, 0, 1);
+        return;
+    }
+    Task task = {fn, arg, 0, 1, &backgroundTasks};
+    pushTask(task, priority);
+    wakeWorkers();
+}
+
+THREAD_MAIN(workerMain) {
+    currentWorker = (int)(intptr_t)arg;
+    Task task;
+    while (true) {
+        if (takeTask(currentWorker, task)) {
+            runTask(task);
+            continue;
+        }
+        mutexLock(executorMutex);
+        bool stopping = executorStop;
+        if (!stopping && queuedTasks <= 0) conditionWait(workAvailable, executorMutex, 100);
+        mutexUnlock(executorMutex);
+        if (stopping) break;
+    }
+    return 0;
+}
+
+void startExecutor() {
+    int count = max(1, min(cpuCount(), MAX_WORKERS));
+    for (int w = 0; w < count; w++) mutexInit(workers[w].lock);
+    executorStop = false;
+    workerCount = count;
+    for (int w = 0; w < count; w++) {
+        if (!startThread(workers[w].thread, workerMain, (void*)(intptr_t)w)) {
+            workerCount = w;
+            break;
+        }
+    }
+}
+
+// Only called once no thread is waiting on a group.
+void stopExecutor() {
+    waitGroup(backgroundTasks);
+    mutexLock(executorMutex);
+    executorStop = true;
+    conditionWakeAll(workAvailable);
+    mutexUnlock(executorMutex);
+    for (int w = 0; w < workerCount; w++) joinThread(workers[w].thread);
+    workerCount = 0;
+}
+
+//  TIMER WHEEL
+// Hierarchical timing wheel with one-second ticks. Level L has 64 slots of
+// 64^L seconds each, so four levels reach about 194 days ahead; a later
+// timer waits in the top level and is filed again when its slot comes round.
+// Timers are nodes in doubly linked slot lists, so adding and cancelling are
+// O(1). Each tick empties one level-0 slot, and every 64^L ticks one slot of
+// level L, whose timers move down to the level that now fits them.
+const int WHEEL_BITS = 6;
+const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+const int WHEEL_LEVELS = 4;
+const long long WHEEL_SPAN = 1LL << (WHEEL_BITS * WHEEL_LEVELS);
+
+struct TimerNode {
+    long long expires;
+    int owner;       // returned when the timer fires; -1 while the node is free
+    int next, prev;  // slot list, or the free list through next
+    int slot;
+};
+
+struct TimerWheel {
+    long long now;
+    int heads[WHEEL_LEVELS * WHEEL_SLOTS];
+    vector<TimerNode> nodes;
+    int freeNode;
+    int active;
+};
+
+void wheelInit(TimerWheel& wheel, long long now) {
+    wheel.now = now;
+    for (int s = 0; s < WHEEL_LEVELS * WHEEL_SLOTS; s++) wheel.heads[s] = -1;
+    wheel.nodes.clear();
+    wheel.freeNode = -1;
+    wheel.active = 0;
+}
+
+// Files a node in the slot of the lowest level whose range covers it.
+void wheelLink(TimerWheel& wheel, int node) {
+    TimerNode& timer = wheel.nodes[node];
+    long long at = min(timer.expires, wheel.now + WHEEL_SPAN - 1);
+    long long delta = at - wheel.now;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (1LL << (WHEEL_BITS * (level + 1)))) level++;
+    timer.slot = level * WHEEL_SLOTS + (int)((at >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1));
+    timer.prev = -1;
+    timer.next = wheel.heads[timer.slot];
+    if (timer.next != -1) wheel.nodes[timer.next].prev = node;
+    wheel.heads[timer.slot] = node;
+}
+
+void wheelRelease(TimerWheel& wheel, int node) {
+    wheel.nodes[node].owner = -1;
+    wheel.nodes[node].next = wheel.freeNode;
+    wheel.freeNode = node;
+    wheel.active--;
+}
+
+// Starts a timer for owner at time expires; returns its node for wheelCancel().
+int wheelAdd(TimerWheel& wheel, long long expires, int owner) {
+    int node = wheel.freeNode;
+    if (node != -1) {
+        wheel.freeNode = wheel.nodes[node].next;
+    } else {
+        node = (int)wheel.nodes.size();
+        wheel.nodes.push_back(TimerNode());
+    }
+    wheel.nodes[node].expires = max(expires, wheel.now + 1);
+    wheel.nodes[node].owner = owner;
+    wheelLink(wheel, node);
+    wheel.active++;
+    return node;
+}
+
+void wheelCancel(TimerWheel& wheel, int node) {
+    TimerNode& timer = wheel.nodes[node];
+    if (timer.owner == -1) return;
+    if (timer.prev != -1) wheel.nodes[timer.prev].next = timer.next;
+    else wheel.heads[timer.slot] = timer.next;
+    if (timer.next != -1) wheel.nodes[timer.next].prev = timer.prev;
+    wheelRelease(wheel, node);
+}
+
+// Empties a slot: due timers fire, the rest are filed again from now.
+void wheelRefile(TimerWheel& wheel, int slot, vector<int>& fired) {
+    int node = wheel.heads[slot];
+    wheel.heads[slot] = -1;
+    while (node != -1) {
+        int next = wheel.nodes[node].next;
+        if (wheel.nodes[node].expires <= wheel.now) {
+            fired.push_back(wheel.nodes[node].owner);
+            wheelRelease(wheel, node);
+        } else {
+            wheelLink(wheel, node);
+        }
+        node = next;
+    }
+}
+
+// Moves the wheel forward to time target and appends the owners of every
+// timer that expired on the way to fired.
+void wheelAdvance(TimerWheel& wheel, long long target, vector<int>& fired) {
+    while (wheel.now < target) {
+        wheel.now++;
+        for (int level = 1; level < WHEEL_LEVELS; level++) {
+            int shift = WHEEL_BITS * level;
+            if ((wheel.now & ((1LL << shift) - 1)) != 0) break;
+            wheelRefile(wheel, level * WHEEL_SLOTS + (int)((wheel.now >> shift) & (WHEEL_SLOTS - 1)), fired);
+        }
+        wheelRefile(wheel, (int)(wheel.now & (WHEEL_SLOTS - 1)), fired);
+    }
+}
+
+//  ATTEMPT TABLE
+// Exam attempts in progress; see TIMED ATTEMPTS.
+struct Attempt {
+    Symbol student;
+    Symbol examId;
+    long long deadline;
+    long long e, n, d;   // the key the student recovered
+    int timer;
+    string answer;
+};
+
+enum AttemptResult { ATTEMPT_STARTED, ATTEMPT_RESUMED, ATTEMPT_NOT_OPEN, ATTEMPT_CLOSED, ATTEMPT_NO_EXAM };
+const int TIMER_POLL_MS = 250;
+// Longest answer whose ciphertext fits AssignmentPayload::encryptedSubmission.
+const size_t MAX_ANSWER = cipherCapacity(sizeof(AssignmentPayload::encryptedSubmission));
+
+ChunkedTable<Attempt> attempts;
+int attemptCount = 0;
+unordered_map<long long, int> openAttempts;   // student and exam -> attempts row
+TimerWheel attemptWheel;
+Mutex attemptsLock = MUTEX_INIT;
+Condition timerWake = CONDITION_INIT;
+bool timerStop = false;
+bool timerRunning = false;
+ThreadHandle timerThread;
+atomic<long long> attemptsStarted(0);
+atomic<long long> attemptsAutoSubmitted(0);
+
+//  SYMBOL TABLE
+// Every username and record id is interned once into symbolNames, and records
+// refer to each other by that 32-bit index. symbolIndex is an open-addressing
+// table (linear probing, power-of-two capacity, load <= 1/2) from the string
+// back to its Symbol, so a name typed by the user costs one hash probe.
+// symbolNames is a deque so the pointers symbolName() hands out stay valid
+// while new symbols are interned.
+struct HashIndex {
+    vector<int> slots;             // row index, -1 when empty
+    int size;
+    const char* (*keyOf)(int row);
+};
+
+deque<string> symbolNames;
+
+const char* symbolKey(int row) { return symbolNames[row].c_str(); }
+
+HashIndex symbolIndex = { vector<int>(), 0, symbolKey };
+
+unsigned hashKey(const char* key) {
+    unsigned hash = 2166136261u;  // FNV-1a
+    for (; *key; key++) {
+        hash ^= (unsigned char)*key;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void indexPlace(HashIndex& index, int row) {
+    unsigned mask = (unsigned)index.slots.size() - 1;
+    unsigned pos = hashKey(index.keyOf(row)) & mask;
+    while (index.slots[pos] != -1) pos = (pos + 1) & mask;
+    index.slots[pos] = row;
+}
+
+void indexInsert(HashIndex& index, int row) {
+    if ((index.size + 1) * 2 > (int)index.slots.size()) {
+        vector<int> old = index.slots;
+        index.slots.assign(old.empty() ? 64 : old.size() * 2, -1);
+        for (int i = 0; i < (int)old.size(); i++) {
+            if (old[i] != -1) indexPlace(index, old[i]);
+        }
+    }
+    indexPlace(index, row);
+    index.size++;
+}
+
+void indexClear(HashIndex& index) {
+    index.slots.clear();
+    index.size = 0;
+}
+
+int indexFind(const HashIndex& index, const char* key) {
+    if (index.slots.empty()) return -1;
+    unsigned mask = (unsigned)index.slots.size() - 1;
+    unsigned pos = hashKey(key) & mask;
+    while (index.slots[pos] != -1) {
+        if (strcmp(index.keyOf(index.slots[pos]), key) == 0) return index.slots[pos];
+        pos = (pos + 1) & mask;
+    }
+    return -1;
+}
+
+// Interning can happen under any table lock, so the symbol table has its own
+// lock, held only inside these three functions.
+RWLock symbolLock = RWLOCK_INIT;
+
+Symbol lookupSymbol(const char* name) {
+    rwRead(symbolLock);
+    Symbol sym = indexFind(symbolIndex, name);
+    rwReadUnlock(symbolLock);
+    return sym;
+}
+
+Symbol intern(string_view name) {
+    string key(name);
+    Symbol sym = lookupSymbol(key.c_str());
+    if (sym != NO_SYMBOL) return sym;
+    rwWrite(symbolLock);
+    sym = indexFind(symbolIndex, key.c_str());   // another thread may have added it
+    if (sym == NO_SYMBOL) {
+        symbolNames.push_back(key);
+        sym = (Symbol)symbolNames.size() - 1;
+        indexInsert(symbolIndex, sym);
+    }
+    rwWriteUnlock(symbolLock);
+    return sym;
+}
+
+// Names never change once interned, so the pointer stays valid after unlock.
+const char* symbolName(Symbol sym) {
+    rwRead(symbolLock);
+    const char* name = (sym >= 0 && sym < (int)symbolNames.size()) ? symbolNames[sym].c_str() : "";
+    rwReadUnlock(symbolLock);
+    return name;
+}
+
+//  BLOOM FILTERS
+// A bit array with BLOOM_HASHES probes per key, sized at BLOOM_BITS_PER_ITEM
+// bits per key (about 1% false positives). A clear bit means the key was never
+// added, so a lookup for a name or code that does not exist stops here without
+// touching the hash index. Filters cannot forget keys; deleted rows drop out
+// when the filters are rebuilt with the indexes.
+const int BLOOM_BITS_PER_ITEM = 10;
+const int BLOOM_HASHES = 7;
+
+struct BloomFilter {
+    vector<unsigned long long> bits;
+    int items;
+    int capacity;                  // keys the bit array was sized for
+    atomic<long long> probes;          // lookups asked
+    atomic<long long> maybes;          // lookups that reached the index
+    atomic<long long> falsePositives;  // maybes the index did not find
+};
+
+void bloomReset(BloomFilter& filter, int expected) {
+    filter.capacity = expected < 256 ? 256 : expected * 2;
+    filter.bits.assign((filter.capacity * BLOOM_BITS_PER_ITEM + 63) / 64, 0);
+    filter.items = 0;
+}
+
+// Double hashing: probe i lands on h1 + i*h2.
+unsigned bloomStep(unsigned h1) {
+    return ((h1 >> 16) | (h1 << 16)) * 0x85ebca6bu | 1u;
+}
+
+// Returns false when the filter is full and must be rebuilt larger.
+bool bloomAdd(BloomFilter& filter, const char* key) {
+    if (filter.items >= filter.capacity) return false;
+    unsigned size = (unsigned)filter.bits.size() * 64;
+    unsigned h1 = hashKey(key), h2 = bloomStep(h1);
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        unsigned bit = (h1 + i * h2) % size;
+        filter.bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    filter.items++;
+    return true;
+}
+
+bool bloomMayContain(BloomFilter& filter, const char* key) {
+    filter.probes++;
+    if (filter.bits.empty()) return false;
+    unsigned size = (unsigned)filter.bits.size() * 64;
+    unsigned h1 = hashKey(key), h2 = bloomStep(h1);
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        unsigned bit = (h1 + i * h2) % size;
+        if (!(filter.bits[bit / 64] & (1ULL << (bit % 64)))) return false;
+    }
+    filter.maybes++;
+    return true;
+}
+
+// Observed false-positive rate: wrong maybes over all absent keys asked.
+double bloomFalsePositiveRate(const BloomFilter& filter) {
+    long long absent = filter.falsePositives + (filter.probes - filter.maybes);
+    return absent > 0 ? (double)filter.falsePositives / absent : 0.0;
+}
+
+//  SYMBOL SETS
+// Roaring-style bitmap over Symbols. Approvals and per-recipient read state
+// are sets of student Symbols, so "approved?" and "read?" are bit tests, and a
+// class-wide grant is a merge of the sorted roster into the set.
+const int SET_ARRAY_MAX = 4096;     // sparse containers convert past this
+const int SET_BITMAP_WORDS = 1024;  // 65536 bits
+
+int bitCount(unsigned long long word) {
+#ifdef _MSC_VER
+    return (int)(__popcnt((unsigned)word) + __popcnt((unsigned)(word >> 32)));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+int setContainerAt(const SymbolSet& set, unsigned short key) {
+    int lo = 0, hi = (int)set.containers.size();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (set.containers[mid].key < key) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+void setMakeBitmap(SetContainer& c) {
+    c.bits.assign(SET_BITMAP_WORDS, 0);
+    for (int i = 0; i < (int)c.values.size(); i++) {
+        c.bits[c.values[i] >> 6] |= 1ULL << (c.values[i] & 63);
+    }
+    vector<unsigned short>().swap(c.values);
+}
+
+bool setContains(const SymbolSet& set, Symbol sym) {
+    if (sym < 0) return false;
+    unsigned short key = (unsigned short)(sym >> 16), low = (unsigned short)(sym & 0xFFFF);
+    int at = setContainerAt(set, key);
+    if (at == (int)set.containers.size() || set.containers[at].key != key) return false;
+    const SetContainer& c = set.containers[at];
+    if (!c.bits.empty()) return (c.bits[low >> 6] >> (low & 63)) & 1;
+    return binary_search(c.values.begin(), c.values.end(), low);
+}
+
+SetContainer& setContainerFor(SymbolSet& set, unsigned short key) {
+    int at = setContainerAt(set, key);
+    if (at == (int)set.containers.size() || set.containers[at].key != key) {
+        SetContainer c = SetContainer();
+        c.key = key;
+        set.containers.insert(set.containers.begin() + at, c);
+    }
+    return set.containers[at];
+}
+
+bool setAdd(SymbolSet& set, Symbol sym) {
+    if (sym < 0) return false;
+    SetContainer& c = setContainerFor(set, (unsigned short)(sym >> 16));
+    unsigned short low = (unsigned short)(sym & 0xFFFF);
+    if (!c.bits.empty()) {
+        unsigned long long bit = 1ULL << (low & 63);
+        if (c.bits[low >> 6] & bit) return false;
+        c.bits[low >> 6] |= bit;
+    } else {
+        vector<unsigned short>::iterator pos = lower_bound(c.values.begin(), c.values.end(), low);
+        if (pos != c.values.end() && *pos == low) return false;
+        c.values.insert(pos, low);
+        if ((int)c.values.size() > SET_ARRAY_MAX) setMakeBitmap(c);
+    }
+    c.cardinality++;
+    return true;
+}
+
+// Merges a sorted list of Symbols (a class roster) into the set, one
+// container at a time: array containers merge, bitmap containers OR bits in.
+void setUnionSorted(SymbolSet& set, const vector<Symbol>& sorted) {
+    int i = 0;
+    while (i < (int)sorted.size()) {
+        if (sorted[i] < 0) { i++; continue; }
+        unsigned short key = (unsigned short)(sorted[i] >> 16);
+        int end = i;
+        while (end < (int)sorted.size() && (sorted[end] >> 16) == key) end++;
+        SetContainer& c = setContainerFor(set, key);
+        if (c.bits.empty() && c.cardinality + (end - i) > SET_ARRAY_MAX) setMakeBitmap(c);
+        if (!c.bits.empty()) {
+            for (int j = i; j < end; j++) {
+                unsigned short low = (unsigned short)(sorted[j] & 0xFFFF);
+                c.bits[low >> 6] |= 1ULL << (low & 63);
+            }
+            c.cardinality = 0;
+            for (int w = 0; w < SET_BITMAP_WORDS; w++) c.cardinality += bitCount(c.bits[w]);
+        } else {
+            vector<unsigned short> lows, merged;
+            for (int j = i; j < end; j++) lows.push_back((unsigned short)(sorted[j] & 0xFFFF));
+            set_union(c.values.begin(), c.values.end(), lows.begin(), lows.end(), back_inserter(merged));
+            c.values.swap(merged);
+            c.cardinality = (int)c.values.size();
+        }
+        i = end;
+    }
+}
+
+int setSize(const SymbolSet& set) {
+    int total = 0;
+    for (int i = 0; i < (int)set.containers.size(); i++) total += set.containers[i].cardinality;
+    return total;
+}
+
+// Members in ascending Symbol order.
+void setMembers(const SymbolSet& set, vector<Symbol>& out) {
+    out.clear();
+    for (int i = 0; i < (int)set.containers.size(); i++) {
+        const SetContainer& c = set.containers[i];
+        Symbol high = (Symbol)c.key << 16;
+        if (!c.bits.empty()) {
+            for (int w = 0; w < SET_BITMAP_WORDS; w++) {
+                for (unsigned long long word = c.bits[w]; word; word &= word - 1) {
+                    int bit = bitCount((word & (~word + 1)) - 1);  // trailing zeros
+                    out.push_back(high | (w * 64 + bit));
+                }
+            }
+        } else {
+            for (int j = 0; j < (int)c.values.size(); j++) out.push_back(high | c.values[j]);
+        }
+    }
+}
+
 //  GLOBAL VARIABLES
 char currentUser[50] = "";
+Symbol currentUserSym = NO_SYMBOL;
 char currentRole[20] = "";
 int idCounter = 1000;
 
@@ -204,19 +1124,41 @@ void drawBoxTop(int width = BOX_WIDTH) {
     resetColor();
 }
 void syncIdCounter() {
-    int maxId = 1000;
+    // Archived records are not loaded, so start from the counter saved in classes.txt
+    int maxId = (idCounter - 1 > 1000) ? idCounter - 1 : 1000;
 
     // Check Classes (CLSxxxx)
     for (int i = 0; i < classCount; i++) {
+        if (!classes.isLive(i)) continue;
         // Skip the first 3 chars ("CLS") and convert the rest to int
-        int currentId = atoi(classes[i].classId + 3); 
+        int currentId = atoi(symbolName(classes[i].classId) + 3); 
         if (currentId > maxId) maxId = currentId;
     }
 
     // Check Exams (EXAMxxxx) - purely to be safe since they share the counter
     for (int i = 0; i < examCount; i++) {
+        if (!exams.isLive(i)) continue;
         // Skip the first 4 chars ("EXAM")
-        int currentId = atoi(exams[i].id + 4);
+        int currentId = atoi(symbolName(exams[i].id) + 4);
+        if (currentId > maxId) maxId = currentId;
+    }
+
+    // Submissions (SUBxxxx) and keys (KEYxxxx) draw from the same counter
+    for (int i = 0; i < assignmentCount; i++) {
+        if (!assignments.isLive(i)) continue;
+        int currentId = atoi(symbolName(assignments[i].id) + 3);
+        if (currentId > maxId) maxId = currentId;
+    }
+    for (int i = 0; i < keyDistCount; i++) {
+        if (!keyDist.isLive(i)) continue;
+        int currentId = atoi(symbolName(keyDist[i].id) + 3);
+        if (currentId > maxId) maxId = currentId;
+    }
+
+    // Messages (MSGxxxx) too; sending one does not save classes.txt
+    for (int i = 0; i < messageCount; i++) {
+        if (!messagesList.isLive(i)) continue;
+        int currentId = atoi(symbolName(messagesList[i].id) + 3);
         if (currentId > maxId) maxId = currentId;
     }
 
@@ -454,6 +1396,297 @@ void displayMessageBanner() {
     resetColor();
 }
 
+//  CSV TOKENIZER
+// Every load* function reads its whole file into one buffer and walks it with
+// these helpers. Fields come back as string_views into that buffer, so nothing
+// is copied until a value is stored and no line length limit applies.
+struct CsvCursor {
+    const char* pos;   // next unread byte, NULL once the last field was taken
+    const char* end;
+};
+
+int csvFirstSetBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return (int)idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Returns the first occurrence of delim in [p, end), or end if there is none.
+// Scans 32 or 16 bytes per step when AVX2 / SSE2 are available.
+const char* csvFindDelimiter(const char* p, const char* end, char delim) {
+#ifdef CSV_USE_AVX2
+    const __m256i needle32 = _mm256_set1_epi8(delim);
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle32));
+        if (mask != 0) return p + csvFirstSetBit(mask);
+        p += 32;
+    }
+#endif
+#ifdef CSV_USE_SSE2
+    const __m128i needle16 = _mm_set1_epi8(delim);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle16));
+        if (mask != 0) return p + csvFirstSetBit(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != delim) p++;
+    return p;
+}
+
+CsvCursor csvCursor(string_view text) {
+    CsvCursor cursor;
+    cursor.pos = text.data();
+    cursor.end = text.data() + text.size();
+    return cursor;
+}
+
+bool csvReadFile(const char* path, string& buffer) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    file.seekg(0, ios::beg);
+    buffer.resize(size > 0 ? (size_t)size : 0);
+    if (size > 0) file.read(&buffer[0], size);
+    file.close();
+    return true;
+}
+
+// Next '\n'-terminated line, without the terminator (and without a '\r').
+bool csvNextLine(CsvCursor& file, string_view& line) {
+    if (file.pos == NULL || file.pos >= file.end) return false;
+    const char* hit = csvFindDelimiter(file.pos, file.end, '\n');
+    const char* stop = hit;
+    if (stop > file.pos && stop[-1] == '\r') stop--;
+    line = string_view(file.pos, stop - file.pos);
+    file.pos = hit + (hit < file.end ? 1 : 0);
+    return true;
+}
+
+// Next field of a row. Empty fields are kept, unlike strtok.
+bool csvNextField(CsvCursor& row, string_view& field, char delim = ',') {
+    if (row.pos == NULL) return false;
+    const char* hit = csvFindDelimiter(row.pos, row.end, delim);
+    field = string_view(row.pos, hit - row.pos);
+    row.pos = (hit < row.end) ? hit + 1 : NULL;
+    return true;
+}
+
+int csvSplit(string_view line, string_view* cols, int maxCols, char delim = ',') {
+    CsvCursor row = csvCursor(line);
+    int count = 0;
+    while (count < maxCols && csvNextField(row, cols[count], delim)) count++;
+    return count;
+}
+
+void csvCopy(char* dest, int destSize, string_view field) {
+    int len = (int)field.size();
+    if (len > destSize - 1) len = destSize - 1;
+    memcpy(dest, field.data(), len);
+    dest[len] = '\0';
+}
+
+long long csvToLL(string_view field) {
+    size_t i = 0;
+    while (i < field.size() && field[i] == ' ') i++;
+    bool negative = false;
+    if (i < field.size() && (field[i] == '-' || field[i] == '+')) negative = (field[i++] == '-');
+    long long value = 0;
+    while (i < field.size() && field[i] >= '0' && field[i] <= '9') {
+        value = value * 10 + (field[i++] - '0');
+    }
+    return negative ? -value : value;
+}
+
+int csvToInt(string_view field) {
+    return (int)csvToLL(field);
+}
+
+//  CIPHERTEXT COLUMN CODEC
+// Per-character RSA turns a message into a few dozen distinct decimal tokens
+// repeated over and over. On disk each ciphertext column is stored as
+//   H1|<distinct tokens>|<code length per token>|<token count>|<base64 bits>
+// i.e. a per-record dictionary plus a canonical Huffman coded index stream.
+// Columns that would not get shorter are written as plain ciphertext, and
+// plain ciphertext is still accepted on load.
+const char* CODEC_TAG = "H1|";
+const char* BASE64_ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const int CODEC_MAX_CODE_LEN = 25;
+
+// Huffman code length per symbol (a single symbol gets length 1).
+void huffmanCodeLengths(const vector<int>& freq, vector<int>& lengths) {
+    int k = (int)freq.size();
+    lengths.assign(k, 0);
+    if (k == 1) {
+        lengths[0] = 1;
+        return;
+    }
+    vector<int> parent(2 * k, -1);
+    typedef pair<long long, int> Node;  // (weight, node id)
+    priority_queue<Node, vector<Node>, greater<Node> > heap;
+    for (int i = 0; i < k; i++) heap.push(Node(freq[i], i));
+    int next = k;
+    while (heap.size() > 1) {
+        Node a = heap.top(); heap.pop();
+        Node b = heap.top(); heap.pop();
+        parent[a.second] = next;
+        parent[b.second] = next;
+        heap.push(Node(a.first + b.first, next++));
+    }
+    for (int i = 0; i < k; i++) {
+        for (int node = i; parent[node] != -1; node = parent[node]) lengths[i]++;
+    }
+}
+
+// Canonical code assignment: symbols ordered by (length, symbol index).
+void canonicalOrder(const vector<int>& lengths, vector<int>& order) {
+    order.resize(lengths.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return lengths[a] < lengths[b]; });
+}
+
+string packCipherColumn(const char* ciphertext) {
+    vector<string_view> dict;
+    vector<int> freq, stream;
+    unordered_map<string_view, int> slot;
+    CsvCursor tokens = csvCursor(ciphertext);
+    string_view token;
+    while (csvNextField(tokens, token, ' ')) {
+        if (token.empty()) continue;
+        auto it = slot.find(token);
+        int sym;
+        if (it == slot.end()) {
+            sym = (int)dict.size();
+            slot[token] = sym;
+            dict.push_back(token);
+            freq.push_back(0);
+        } else {
+            sym = it->second;
+        }
+        freq[sym]++;
+        stream.push_back(sym);
+    }
+    if (stream.empty()) return string(ciphertext);
+
+    vector<int> lengths, order;
+    huffmanCodeLengths(freq, lengths);
+    for (int len : lengths) {
+        if (len > CODEC_MAX_CODE_LEN) return string(ciphertext);
+    }
+    canonicalOrder(lengths, order);
+    vector<unsigned> codes(dict.size());
+    unsigned code = 0;
+    int prevLen = lengths[order[0]];
+    for (int i = 0; i < (int)order.size(); i++) {
+        int len = lengths[order[i]];
+        code <<= (len - prevLen);
+        prevLen = len;
+        codes[order[i]] = code++;
+    }
+
+    string out = CODEC_TAG;
+    for (int i = 0; i < (int)dict.size(); i++) {
+        if (i > 0) out += ' ';
+        out.append(dict[i].data(), dict[i].size());
+    }
+    out += '|';
+    for (int len : lengths) out += (char)('a' + len);
+    out += '|';
+    out += to_string(stream.size());
+    out += '|';
+
+    unsigned bitBuffer = 0;
+    int bitCount = 0;
+    for (int sym : stream) {
+        for (int b = lengths[sym] - 1; b >= 0; b--) {
+            bitBuffer = (bitBuffer << 1) | ((codes[sym] >> b) & 1);
+            if (++bitCount == 6) {
+                out += BASE64_ALPHABET[bitBuffer];
+                bitBuffer = 0;
+                bitCount = 0;
+            }
+        }
+    }
+    if (bitCount > 0) out += BASE64_ALPHABET[bitBuffer << (6 - bitCount)];
+
+    if (out.size() >= strlen(ciphertext)) return string(ciphertext);
+    return out;
+}
+
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+// Expands a stored column into "tok tok ... " form. Plain columns are copied.
+void unpackCipherColumn(string_view stored, char* dest, int destSize) {
+    if (stored.substr(0, 3) != CODEC_TAG) {
+        csvCopy(dest, destSize, stored);
+        return;
+    }
+    dest[0] = '\0';
+    string_view parts[4];
+    if (csvSplit(stored.substr(3), parts, 4, '|') < 4) return;
+
+    vector<string_view> dict;
+    CsvCursor tokens = csvCursor(parts[0]);
+    string_view token;
+    while (csvNextField(tokens, token, ' ')) dict.push_back(token);
+    if (dict.size() != parts[1].size()) return;
+
+    vector<int> lengths(dict.size()), order;
+    int count[CODEC_MAX_CODE_LEN + 1] = {0};
+    for (int i = 0; i < (int)dict.size(); i++) {
+        lengths[i] = parts[1][i] - 'a';
+        if (lengths[i] < 1 || lengths[i] > CODEC_MAX_CODE_LEN) return;
+        count[lengths[i]]++;
+    }
+    canonicalOrder(lengths, order);
+
+    long long remaining = csvToLL(parts[2]);
+    string_view bits = parts[3];
+    size_t bitPos = 0, totalBits = bits.size() * 6;
+    int used = 0;
+    while (remaining > 0) {
+        // Canonical decode: walk lengths until the code falls inside one.
+        unsigned code = 0, first = 0;
+        int index = 0, len = 1;
+        int sym = -1;
+        for (; len <= CODEC_MAX_CODE_LEN && bitPos < totalBits; len++) {
+            int v = base64Value(bits[bitPos / 6]);
+            if (v < 0) return;
+            code |= (v >> (5 - bitPos % 6)) & 1;
+            bitPos++;
+            if (code - first < (unsigned)count[len]) {
+                sym = order[index + (code - first)];
+                break;
+            }
+            index += count[len];
+            first = (first + count[len]) << 1;
+            code <<= 1;
+        }
+        if (sym < 0) return;
+        int tokenLen = (int)dict[sym].size();
+        if (used + tokenLen + 1 >= destSize) return;
+        memcpy(dest + used, dict[sym].data(), tokenLen);
+        used += tokenLen;
+        dest[used++] = ' ';
+        dest[used] = '\0';
+        remaining--;
+    }
+}
+
 //  RSA UTILITY FUNCTIONS 
 bool isPrime(long long n) {
     if (n < 2) return false;
@@ -465,10 +1698,25 @@ bool isPrime(long long n) {
     return true;
 }
 
+// Per-thread xorshift generator, so keys can be generated on any worker.
+thread_local unsigned long long rngState = 0;
+atomic<unsigned long long> rngStreams(0);
+
+unsigned long long randomNext() {
+    if (rngState == 0) {
+        rngState = ((unsigned long long)time(0) << 20) ^ (++rngStreams * 0x9E3779B97F4A7C15ULL);
+        if (rngState == 0) rngState = 1;
+    }
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 0x2545F4914F6CDD1DULL;
+}
+
 long long generatePrime(long long min, long long max) {
     long long prime;
     do {
-        prime = min + rand() % (max - min + 1);
+        prime = min + (long long)(randomNext() % (unsigned long long)(max - min + 1));
     } while (!isPrime(prime));
     return prime;
 }
@@ -535,32 +1783,69 @@ void generateRSAKeys(RSAKeys& keys) {
     keys.d = modInverse(keys.e, keys.phi);
 }
 
-void encryptMessage(const char* plaintext, char* ciphertext, long long e, long long n) {
-    ciphertext[0] = '\0';
-    char temp[20];
+// Long messages are split into chunks of CRYPT_GRAIN characters on the executor.
+const int CRYPT_GRAIN = 256;
+
+struct ModPowJob {
+    long long* values;
+    long long exp;
+    long long n;
+};
+
+void modPowRange(void* arg, int begin, int end) {
+    ModPowJob* job = (ModPowJob*)arg;
+    for (int i = begin; i < end; i++) job->values[i] = modPow(job->values[i], job->exp, job->n);
+}
+
+void encryptMessage(const char* plaintext, char* ciphertext, long long e, long long n,
+                    TaskPriority priority = PRIORITY_INTERACTIVE) {
     int len = strlen(plaintext);
-    for (int i = 0; i < len; i++) {
-        long long m = (long long)(unsigned char)plaintext[i];
-        long long c = modPow(m, e, n);
-        sprintf(temp, "%lld ", c);
-        strcat(ciphertext, temp);
+    vector<long long> values(len);
+    for (int i = 0; i < len; i++) values[i] = (unsigned char)plaintext[i];
+    ModPowJob job = {values.data(), e, n};
+    parallelFor(0, len, CRYPT_GRAIN, modPowRange, &job, priority);
+    char* out = ciphertext;
+    for (int i = 0; i < len; i++) out += sprintf(out, "%lld ", values[i]);
+    *out = '\0';
+}
+
+void decryptMessage(const char* ciphertext, char* plaintext, long long d, long long n,
+                    TaskPriority priority = PRIORITY_INTERACTIVE) {
+    CsvCursor tokens = csvCursor(ciphertext);
+    string_view token;
+    vector<long long> values;
+    while (csvNextField(tokens, token, ' ')) {
+        if (!token.empty()) values.push_back(csvToLL(token));
     }
+    ModPowJob job = {values.data(), d, n};
+    parallelFor(0, (int)values.size(), CRYPT_GRAIN, modPowRange, &job, priority);
+    for (int i = 0; i < (int)values.size(); i++) plaintext[i] = (char)values[i];
+    plaintext[values.size()] = '\0';
 }
 
-void decryptMessage(const char* ciphertext, char* plaintext, long long d, long long n) {
-    plaintext[0] = '\0';
-    char temp[5000];
-    strncpy(temp, ciphertext, sizeof(temp) - 1);
-    temp[sizeof(temp) - 1] = '\0';
-    char* token = strtok(temp, " ");
-    int idx = 0;
-    while (token != NULL) {
-        long long c = atoll(token);
-        long long m = modPow(c, d, n);
-        plaintext[idx++] = (char)m;
-        token = strtok(NULL, " ");
+// Decrypts a batch of messages as bulk work, one task per message.
+struct DecryptJob {
+    const char* ciphertext;
+    long long d;
+    long long n;
+    char plaintext[5000];
+};
+
+void decryptRange(void* arg, int begin, int end) {
+    DecryptJob* jobs = (DecryptJob*)arg;
+    for (int i = begin; i < end; i++) {
+        decryptMessage(jobs[i].ciphertext, jobs[i].plaintext, jobs[i].d, jobs[i].n, PRIORITY_BULK);
     }
-    plaintext[idx] = '\0';
+}
+
+void decryptAll(vector<DecryptJob>& jobs) {
+    parallelFor(0, (int)jobs.size(), 1, decryptRange, jobs.data(), PRIORITY_BULK);
+}
+
+// Exam rows saved without their key columns load with n = 0, which modPow()
+// would divide by. Such exams cannot decrypt anything.
+bool hasExamKey(const ExamPayload& payload) {
+    return payload.exam_n > 1 && payload.exam_d > 0;
 }
 
 //  NEW RSA FEATURES 
@@ -648,72 +1933,301 @@ long long hashPassword(const char* password) {
     return hash;
 }
 
-void generateId(char* id, const char* prefix) {
-    sprintf(id, "%s%d", prefix, idCounter++);
+Symbol generateId(const char* prefix) {
+    char id[20];
+    rwWrite(symbolLock);
+    int next = idCounter++;
+    rwWriteUnlock(symbolLock);
+    sprintf(id, "%s%d", prefix, next);
+    return intern(id);
 }
 
-void generateClassCode(char* code) {
-    for (int i = 0; i < 6; i++) {
-        code[i] = '0' + (rand() % 10);
+//  ROW INDEXES
+// Symbol -> row in users[] / classes[] / exams[] / assignments[]. Inserts set
+// their row; loading and row removal rebuild the whole index.
+struct RowIndex {
+    vector<int> rows;   // indexed by Symbol, -1 when absent
+};
+
+RowIndex userIndex, classIndex, examIndex, assignmentIndex;
+
+void indexSet(RowIndex& index, Symbol key, int row) {
+    if (key < 0) return;
+    if (key >= (int)index.rows.size()) index.rows.resize(key + 1, -1);
+    index.rows[key] = row;
+}
+
+int indexRow(const RowIndex& index, Symbol key) {
+    return (key >= 0 && key < (int)index.rows.size()) ? index.rows[key] : -1;
+}
+
+// Inverted index for the student views: student -> enrolled classes and
+// student -> keys addressed to them, plus class -> class-wide keys. A student
+// sees their direct keys and the class-wide keys of each of their classes, so
+// dashboards and key listings cost only as much as what they show.
+struct StudentView {
+    vector<Symbol> classes;
+    vector<int> directKeys;   // rows in keyDist[]
+};
+
+vector<StudentView> studentViews;     // indexed by student Symbol
+vector<vector<int>> classWideKeys;    // indexed by class Symbol
+
+StudentView& studentView(Symbol student) {
+    if (student >= (int)studentViews.size()) studentViews.resize(student + 1);
+    return studentViews[student];
+}
+
+void indexEnrollment(Symbol student, Symbol classId) {
+    if (student < 0) return;
+    studentView(student).classes.push_back(classId);
+}
+
+void indexKeyDist(int keyIdx) {
+    const KeyDistribution& k = keyDist[keyIdx];
+    if (k.isClassWide) {
+        if (k.classId < 0) return;
+        if (k.classId >= (int)classWideKeys.size()) classWideKeys.resize(k.classId + 1);
+        classWideKeys[k.classId].push_back(keyIdx);
+    } else if (k.toStudent >= 0) {
+        studentView(k.toStudent).directKeys.push_back(keyIdx);
     }
-    code[6] = '\0';
 }
 
-int findUser(const char* username) {
-    for (int i = 0; i < userCount; i++) {
-        if (strcmp(users[i].username, username) == 0) {
-            return i;
-        }
+// Key rows visible to a student, in keyDist[] order.
+void visibleKeys(Symbol student, vector<int>& rows) {
+    rows.clear();
+    if (student < 0 || student >= (int)studentViews.size()) return;
+    const StudentView& view = studentViews[student];
+    rows = view.directKeys;
+    for (int i = 0; i < (int)view.classes.size(); i++) {
+        Symbol c = view.classes[i];
+        if (c < (int)classWideKeys.size()) rows.insert(rows.end(), classWideKeys[c].begin(), classWideKeys[c].end());
     }
-    return -1;
+    sort(rows.begin(), rows.end());
 }
 
-int findClass(const char* classId) {
-    for (int i = 0; i < classCount; i++) {
-        if (strcmp(classes[i].classId, classId) == 0) {
-            return i;
-        }
+// Ownership index for the teacher views: teacher -> rows of their classes,
+// exams and access requests, plus a running count of pending requests that
+// is bumped as request rows are indexed instead of recounted per redraw.
+struct TeacherView {
+    vector<int> classes;    // rows in classes[]
+    vector<int> exams;      // rows in exams[]
+    vector<int> requests;   // rows in requests[]
+    int pendingRequests;
+};
+
+vector<TeacherView> teacherViews;     // indexed by teacher Symbol
+
+// Read paths use this one: it never grows teacherViews, so it is safe under a
+// shared lock.
+const TeacherView& viewOfTeacher(Symbol teacher) {
+    static const TeacherView none = TeacherView();
+    return (teacher >= 0 && teacher < (int)teacherViews.size()) ? teacherViews[teacher] : none;
+}
+
+TeacherView& teacherView(Symbol teacher) {
+    static TeacherView none;
+    if (teacher < 0) {
+        none = TeacherView();
+        return none;
     }
-    return -1;
+    if (teacher >= (int)teacherViews.size()) teacherViews.resize(teacher + 1);
+    return teacherViews[teacher];
 }
 
-int findExam(const char* examId) {
-    for (int i = 0; i < examCount; i++) {
-        if (strcmp(exams[i].id, examId) == 0) {
-            return i;
+void indexTeacherClass(int classIdx) {
+    teacherView(classes[classIdx].teacherName).classes.push_back(classIdx);
+}
+
+void indexTeacherExam(int examIdx) {
+    teacherView(exams[examIdx].teacherName).exams.push_back(examIdx);
+}
+
+void indexRequest(int requestIdx) {
+    TeacherView& view = teacherView(requests[requestIdx].teacherName);
+    view.requests.push_back(requestIdx);
+    if (strcmp(requests[requestIdx].status, "pending") == 0) view.pendingRequests++;
+}
+
+// Shard index: class -> rows of its exams and key distributions, which is
+// what shards/<classId>/ holds, so writing a shard visits only its own rows.
+// Rows whose class is gone are listed in orphanRows and written with the
+// unsharded rows. Both inserts hold TABLE_EXAMS for writing; removals
+// rebuild it with the other indexes.
+struct ShardRows {
+    vector<int> exams;   // rows in exams[]
+    vector<int> keys;    // rows in keyDist[]
+};
+
+vector<ShardRows> shardRows;   // indexed by class Symbol
+ShardRows orphanRows;
+
+ShardRows& rowsOfClass(Symbol classId) {
+    if (indexRow(classIndex, classId) == -1) return orphanRows;
+    if (classId >= (int)shardRows.size()) shardRows.resize(classId + 1);
+    return shardRows[classId];
+}
+
+void indexShardExam(int examIdx) {
+    rowsOfClass(exams[examIdx].assignedClassId).exams.push_back(examIdx);
+}
+
+void indexShardKey(int keyIdx) {
+    rowsOfClass(keyDist[keyIdx].classId).keys.push_back(keyIdx);
+}
+
+// Mailbox index: recipient -> rows of their messages in arrival order, plus
+// an unread count that sends and reads adjust as they happen, so inbox pages
+// and dashboard badges never scan messagesList[]. It is rebuilt only when
+// message rows are loaded or moved, under TABLE_MESSAGES.
+struct Mailbox {
+    vector<int> messages;   // rows in messagesList[]
+    int unread;
+};
+
+vector<Mailbox> mailboxes;   // indexed by recipient Symbol
+
+// Safe under a shared lock, like viewOfTeacher().
+const Mailbox& mailboxOf(Symbol user) {
+    static const Mailbox none = Mailbox();
+    return (user >= 0 && user < (int)mailboxes.size()) ? mailboxes[user] : none;
+}
+
+void indexMessage(int row) {
+    Symbol to = messagesList[row].to;
+    if (to < 0) return;
+    if (to >= (int)mailboxes.size()) mailboxes.resize(to + 1);
+    mailboxes[to].messages.push_back(row);
+    if (!messagesList[row].isRead) mailboxes[to].unread++;
+}
+
+void rebuildMailboxes() {
+    mailboxes.clear();
+    for (int i = 0; i < messageCount; i++) if (messagesList.isLive(i)) indexMessage(i);
+}
+
+// Join code -> row in classes[], so joining by code is one hash probe and new
+// codes can be checked for collisions before they are handed out.
+const char* classCodeKey(int row) { return classes[row].classCode; }
+
+HashIndex classCodeIndex = { vector<int>(), 0, classCodeKey };
+
+// Usernames and join codes are typed by hand (and codes can be guessed), so
+// both lookups ask a Bloom filter first and only probe on a maybe.
+BloomFilter userBloom;
+BloomFilter classCodeBloom;
+
+// Each filter is covered by its table's lock, so an insert that outgrows
+// one rebuilds only that one.
+void rebuildUserBloom() {
+    bloomReset(userBloom, liveRows(users, userCount));
+    for (int i = 0; i < userCount; i++) if (users.isLive(i)) bloomAdd(userBloom, symbolName(users[i].username));
+}
+
+void rebuildClassCodeBloom() {
+    bloomReset(classCodeBloom, liveRows(classes, classCount));
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i)) bloomAdd(classCodeBloom, classes[i].classCode);
+}
+
+void rebuildBloomFilters() {
+    rebuildUserBloom();
+    rebuildClassCodeBloom();
+}
+
+int findClassByCode(const char* code) {
+    if (!bloomMayContain(classCodeBloom, code)) return -1;
+    int row = indexFind(classCodeIndex, code);
+    if (row == -1) classCodeBloom.falsePositives++;
+    return row;
+}
+
+void generateClassCode(char* code) {
+    do {
+        for (int i = 0; i < 6; i++) {
+            code[i] = '0' + (rand() % 10);
+        }
+        code[6] = '\0';
+    } while (findClassByCode(code) != -1);
+}
+
+void rebuildIndexes() {
+    userIndex.rows.clear();
+    classIndex.rows.clear();
+    examIndex.rows.clear();
+    assignmentIndex.rows.clear();
+    for (int i = 0; i < userCount; i++) if (users.isLive(i)) indexSet(userIndex, users[i].username, i);
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i)) indexSet(classIndex, classes[i].classId, i);
+    for (int i = 0; i < examCount; i++) if (exams.isLive(i)) indexSet(examIndex, exams[i].id, i);
+    indexClear(classCodeIndex);
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i)) indexInsert(classCodeIndex, i);
+    for (int i = 0; i < assignmentCount; i++) if (assignments.isLive(i)) indexSet(assignmentIndex, assignments[i].id, i);
+    rebuildBloomFilters();
+
+    studentViews.clear();
+    classWideKeys.clear();
+    for (int i = 0; i < classCount; i++) {
+        if (!classes.isLive(i)) continue;
+        for (int j = 0; j < (int)classes[i].enrolledStudents.size(); j++) {
+            indexEnrollment(classes[i].enrolledStudents[j], classes[i].classId);
         }
     }
-    return -1;
+    for (int i = 0; i < keyDistCount; i++) if (keyDist.isLive(i)) indexKeyDist(i);
+
+    teacherViews.clear();
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i)) indexTeacherClass(i);
+    for (int i = 0; i < examCount; i++) if (exams.isLive(i)) indexTeacherExam(i);
+    for (int i = 0; i < requestCount; i++) if (requests.isLive(i)) indexRequest(i);
+
+    shardRows.clear();
+    orphanRows = ShardRows();
+    for (int i = 0; i < examCount; i++) if (exams.isLive(i)) indexShardExam(i);
+    for (int i = 0; i < keyDistCount; i++) if (keyDist.isLive(i)) indexShardKey(i);
+}
+
+int findUser(Symbol username) { return indexRow(userIndex, username); }
+int findClass(Symbol classId) { return indexRow(classIndex, classId); }
+int findExam(Symbol examId) { return indexRow(examIndex, examId); }
+int findAssignment(Symbol submissionId) { return indexRow(assignmentIndex, submissionId); }
+
+int findUser(const char* username) {
+    if (!bloomMayContain(userBloom, username)) return -1;
+    int row = findUser(lookupSymbol(username));
+    if (row == -1) userBloom.falsePositives++;
+    return row;
+}
+int findClass(const char* classId) { return findClass(lookupSymbol(classId)); }
+int findExam(const char* examId) { return findExam(lookupSymbol(examId)); }
+
+// Rosters are kept sorted by Symbol, so membership is a binary search and
+// there is no cap on class size.
+bool rosterContains(const vector<Symbol>& roster, Symbol student) {
+    return binary_search(roster.begin(), roster.end(), student);
+}
+
+bool rosterInsert(vector<Symbol>& roster, Symbol student) {
+    vector<Symbol>::iterator pos = lower_bound(roster.begin(), roster.end(), student);
+    if (pos != roster.end() && *pos == student) return false;
+    roster.insert(pos, student);
+    return true;
 }
 
-bool isStudentInClass(const char* studentName, const char* classId) {
+bool isStudentInClass(Symbol studentName, Symbol classId) {
     int classIdx = findClass(classId);
     if (classIdx == -1) return false;
-    for (int i = 0; i < classes[classIdx].studentCount; i++) {
-        if (strcmp(classes[classIdx].enrolledStudents[i], studentName) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return rosterContains(classes[classIdx].enrolledStudents, studentName);
 }
 
 int countPendingRequests() {
-    int count = 0;
-    for (int i = 0; i < requestCount; i++) {
-        if (strcmp(requests[i].teacherName, currentUser) == 0 &&
-            strcmp(requests[i].status, "pending") == 0) {
-            count++;
-        }
-    }
-    return count;
+    return viewOfTeacher(currentUserSym).pendingRequests;
 }
 
 int countUnreadKeys() {
     int count = 0;
-    for (int i = 0; i < keyDistCount; i++) {
-        bool forMe = (strcmp(keyDist[i].toStudent, currentUser) == 0) ||
-                     (keyDist[i].isClassWide && isStudentInClass(currentUser, keyDist[i].classId));
-        if (forMe && !keyDist[i].isRead) {
+    vector<int> rows;
+    visibleKeys(currentUserSym, rows);
+    for (int r = 0; r < (int)rows.size(); r++) {
+        if (!setContains(keyDist[rows[r]].readers, currentUserSym)) {
             count++;
         }
     }
@@ -721,12 +2235,24 @@ int countUnreadKeys() {
 }
 
 //FILE HANDLING 
+// classes.txt and messagesList.txt keep one line per row, so a deleted row is
+// written as a tombstone and comes back as a free row on load until the table
+// is compacted. Users and access requests are never deleted.
+const char* TOMBSTONE = "~";
+
+template <typename T>
+void loadTombstone(ChunkedTable<T>& table, int& count) {
+    table.ensure(count);
+    freeRow(table, count);
+    count++;
+}
+
 void saveUsers() {
     ofstream file("users.txt");
     if (!file.is_open()) return;
     file << userCount << "\n";
     for (int i = 0; i < userCount; i++) {
-        file << users[i].username << ","
+        file << symbolName(users[i].username) << ","
              << users[i].password << ","
              << users[i].role << ","
              << users[i].keys.n << ","
@@ -741,307 +2267,467 @@ void saveUsers() {
 }
 
 void loadUsers() {
-    ifstream file("users.txt");
-    if (!file.is_open()) return;
-    file >> userCount;
-    file.ignore();
-    for (int i = 0; i < userCount; i++) {
-        char line[1000];
-        file.getline(line, 1000);
-        char* token = strtok(line, ",");
-        if (token) strncpy(users[i].username, token, 49); users[i].username[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(users[i].password, token, 49); users[i].password[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(users[i].role, token, 19); users[i].role[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.n = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.e = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.d = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.p = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.q = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].keys.phi = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) users[i].isActive = atoi(token);
+    string buffer;
+    if (!csvReadFile("users.txt", buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    userCount = 0;
+    clearRows(users);
+    while (csvNextLine(file, line)) {
+        string_view cols[10];
+        if (csvSplit(line, cols, 10) < 10) continue;
+        User& u = users.ensure(userCount);
+        u.username = intern(cols[0]);
+        csvCopy(u.password, sizeof(u.password), cols[1]);
+        csvCopy(u.role, sizeof(u.role), cols[2]);
+        u.keys.n = csvToLL(cols[3]);
+        u.keys.e = csvToLL(cols[4]);
+        u.keys.d = csvToLL(cols[5]);
+        u.keys.p = csvToLL(cols[6]);
+        u.keys.q = csvToLL(cols[7]);
+        u.keys.phi = csvToLL(cols[8]);
+        u.isActive = csvToInt(cols[9]);
+        userCount++;
     }
-    file.close();
+}
+
+void writeClassRow(ostream& file, const Classroom& c) {
+    file << symbolName(c.classId) << ","
+         << c.className << ","
+         << c.classCode << ","
+         << symbolName(c.teacherName) << ","
+         << c.enrolledStudents.size() << ",";
+    if (c.enrolledStudents.empty()) {
+        file << "NONE";
+    } else {
+        for (int j = 0; j < (int)c.enrolledStudents.size(); j++) {
+            file << symbolName(c.enrolledStudents[j]);
+            if (j < (int)c.enrolledStudents.size() - 1) file << ";";
+        }
+    }
+    file << "," << c.assignedExams.size() << ",";
+    if (c.assignedExams.empty()) {
+        file << "NONE";
+    } else {
+        for (int j = 0; j < (int)c.assignedExams.size(); j++) {
+            file << symbolName(c.assignedExams[j]);
+            if (j < (int)c.assignedExams.size() - 1) file << ";";
+        }
+    }
+    file << "," << c.isActive << "\n";
 }
 
 void saveClasses() {
     ofstream file("classes.txt");
     if (!file.is_open()) return;
-    file << classCount << "\n";
+    rwRead(symbolLock);
+    int nextId = idCounter;
+    rwReadUnlock(symbolLock);
+    file << classCount << "," << nextId << "\n";
     for (int i = 0; i < classCount; i++) {
-        file << classes[i].classId << ","
-             << classes[i].className << ","
-             << classes[i].classCode << ","
-             << classes[i].teacherName << ","
-             << classes[i].studentCount << ",";
-        if (classes[i].studentCount == 0) {
-            file << "NONE";
-        } else {
-            for (int j = 0; j < classes[i].studentCount; j++) {
-                file << classes[i].enrolledStudents[j];
-                if (j < classes[i].studentCount - 1) file << ";";
-            }
+        if (!classes.isLive(i)) {
+            file << TOMBSTONE << "\n";
+            continue;
         }
-        file << "," << classes[i].examCount << ",";
-        if (classes[i].examCount == 0) {
-            file << "NONE";
-        } else {
-            for (int j = 0; j < classes[i].examCount; j++) {
-                file << classes[i].assignedExams[j];
-                if (j < classes[i].examCount - 1) file << ";";
-            }
-        }
-        file << "," << classes[i].isActive << "\n";
+        writeClassRow(file, classes[i]);
     }
     file.close();
 }
 
-void loadClasses() {
-    ifstream file("classes.txt");
-    if (!file.is_open()) {
-        classCount = 0;
-        return;
-    }
-    int fileHeaderCount;
-    file >> fileHeaderCount;
-    file.ignore();
-    classCount = 0;
-    char line[2000];
-    while (file.getline(line, 2000) && classCount < MAX_CLASSES) {
-        char* cols[20];
-        int colIdx = 0;
-        char* ptr = strtok(line, ",");
-        while (ptr != NULL && colIdx < 20) {
-            cols[colIdx++] = ptr;
-            ptr = strtok(NULL, ",");
-        }
-        if (colIdx < 8) continue;
-        strncpy(classes[classCount].classId, cols[0], 19); classes[classCount].classId[19] = '\0';
-        strncpy(classes[classCount].className, cols[1], 99); classes[classCount].className[99] = '\0';
-        strncpy(classes[classCount].classCode, cols[2], 9); classes[classCount].classCode[9] = '\0';
-        strncpy(classes[classCount].teacherName, cols[3], 49); classes[classCount].teacherName[49] = '\0';
-        classes[classCount].studentCount = atoi(cols[4]);
-        if (strcmp(cols[5], "NONE") != 0) {
-            char tempStudents[1000];
-            strncpy(tempStudents, cols[5], 999); tempStudents[999] = '\0';
-            char* student = strtok(tempStudents, ";");
-            int j = 0;
-            while (student != NULL && j < classes[classCount].studentCount) {
-                strncpy(classes[classCount].enrolledStudents[j++], student, 49);
-                classes[classCount].enrolledStudents[j-1][49] = '\0';
-                student = strtok(NULL, ";");
-            }
+bool parseClassRow(string_view line, Classroom& c) {
+    string_view cols[9];
+    if (csvSplit(line, cols, 9) < 9) return false;
+    c.classId = intern(cols[0]);
+    csvCopy(c.className, sizeof(c.className), cols[1]);
+    csvCopy(c.classCode, sizeof(c.classCode), cols[2]);
+    c.teacherName = intern(cols[3]);
+    c.enrolledStudents.clear();
+    if (cols[5] != "NONE") {
+        CsvCursor list = csvCursor(cols[5]);
+        string_view student;
+        while ((int)c.enrolledStudents.size() < csvToInt(cols[4]) && csvNextField(list, student, ';')) {
+            c.enrolledStudents.push_back(intern(student));
         }
-        classes[classCount].examCount = atoi(cols[6]);
-        if (strcmp(cols[7], "NONE") != 0) {
-            char tempExams[1000];
-            strncpy(tempExams, cols[7], 999); tempExams[999] = '\0';
-            char* exam = strtok(tempExams, ";");
-            int j = 0;
-            while (exam != NULL && j < classes[classCount].examCount) {
-                strncpy(classes[classCount].assignedExams[j++], exam, 19);
-                classes[classCount].assignedExams[j-1][19] = '\0';
-                exam = strtok(NULL, ";");
-            }
+        sort(c.enrolledStudents.begin(), c.enrolledStudents.end());
+    }
+    c.assignedExams.clear();
+    if (cols[7] != "NONE") {
+        CsvCursor list = csvCursor(cols[7]);
+        string_view exam;
+        while ((int)c.assignedExams.size() < csvToInt(cols[6]) && csvNextField(list, exam, ';')) {
+            c.assignedExams.push_back(intern(exam));
         }
-        classes[classCount].isActive = atoi(cols[8]);
-        classCount++;
     }
-    file.close();
+    c.isActive = csvToInt(cols[8]);
+    return true;
 }
 
-void saveExams() {
-    ofstream file("exams.txt");
-    if (!file.is_open()) return;
-    file << examCount << "\n";
-    for (int i = 0; i < examCount; i++) {
-        file << exams[i].id << ","
-             << exams[i].title << ","
-             << exams[i].encryptedContent << ","
-             << exams[i].teacherName << ","
-             << exams[i].assignedClassId << ","
-             << exams[i].assignedClassName << ","
-             << exams[i].duration << ","
-             << exams[i].isActive << ","
-             << exams[i].approvedCount << ",";
-        if (exams[i].approvedCount == 0) {
-            file << "NONE";
-        } else {
-            for (int j = 0; j < exams[i].approvedCount; j++) {
-                file << exams[i].approvedStudents[j];
-                if (j < exams[i].approvedCount - 1) file << ";";
-            }
+void loadClasses() {
+    classCount = 0;
+    clearRows(classes);
+    string buffer;
+    if (!csvReadFile("classes.txt", buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count, next free id
+    string_view header[2];
+    if (csvSplit(line, header, 2) == 2) idCounter = csvToInt(header[1]);
+    while (csvNextLine(file, line)) {
+        if (line == TOMBSTONE) {
+            loadTombstone(classes, classCount);
+            continue;
         }
-        file << "," << exams[i].keyDistributed << ","
-             << exams[i].signature.signedBy << ","
-             << exams[i].signature.signatureHash << ","
-             << exams[i].signature.isVerified << ","
-             << exams[i].exam_n << ","
-             << exams[i].exam_e << ","
-             << exams[i].exam_d << ","
-             << exams[i].exam_p << ","
-             << exams[i].exam_q << "\n";
+        if (parseClassRow(line, classes.ensure(classCount))) classCount++;
     }
-    file.close();
 }
 
-void loadExams() {
-    ifstream file("exams.txt");
-    if (!file.is_open()) return;
-    file >> examCount;
-    file.ignore();
-    for (int i = 0; i < examCount; i++) {
-        char line[6000];
-        file.getline(line, 6000);
-        char* cols[30];
-        int colIdx = 0;
-        char* ptr = strtok(line, ",");
-        while (ptr != NULL && colIdx < 20) {
-            cols[colIdx++] = ptr;
-            ptr = strtok(NULL, ",");
-        }
-        if (colIdx < 10) continue;
-        strncpy(exams[i].id, cols[0], 19); exams[i].id[19] = '\0';
-        strncpy(exams[i].title, cols[1], 99); exams[i].title[99] = '\0';
-        strncpy(exams[i].encryptedContent, cols[2], 4999); exams[i].encryptedContent[4999] = '\0';
-        strncpy(exams[i].teacherName, cols[3], 49); exams[i].teacherName[49] = '\0';
-        strncpy(exams[i].assignedClassId, cols[4], 19); exams[i].assignedClassId[19] = '\0';
-        strncpy(exams[i].assignedClassName, cols[5], 99); exams[i].assignedClassName[99] = '\0';
-        exams[i].duration = atoi(cols[6]);
-        exams[i].isActive = atoi(cols[7]);
-        exams[i].approvedCount = atoi(cols[8]);
-        if (strcmp(cols[9], "NONE") != 0) {
-            char tempStudents[1000];
-            strncpy(tempStudents, cols[9], 999); tempStudents[999] = '\0';
-            char* student = strtok(tempStudents, ";");
-            int j = 0;
-            while (student != NULL && j < exams[i].approvedCount) {
-                strncpy(exams[i].approvedStudents[j++], student, 49);
-                exams[i].approvedStudents[j-1][49] = '\0';
-                student = strtok(NULL, ";");
-            }
-        }
-        exams[i].keyDistributed = atoi(cols[10]);
-        if (colIdx > 13) {
-            strncpy(exams[i].signature.signedBy, cols[11], 49);
-            exams[i].signature.signatureHash = atoll(cols[12]);
-            exams[i].signature.isVerified = atoi(cols[13]);
-            ptr = strtok(NULL, ","); if(ptr) exams[i].exam_n = atoll(ptr);
-        ptr = strtok(NULL, ","); if(ptr) exams[i].exam_e = atoll(ptr);
-        ptr = strtok(NULL, ","); if(ptr) exams[i].exam_d = atoll(ptr);
-        ptr = strtok(NULL, ","); if(ptr) exams[i].exam_p = atoll(ptr);
-        ptr = strtok(NULL, ","); if(ptr) exams[i].exam_q = atoll(ptr);
-        }
-    }
-    file.close();
+//  SHARDED STORAGE
+// classes.txt, users.txt, requests.txt and messagesList.txt are global. Each
+// class keeps its own exams, assignments and key distributions under
+// shards/<classId>/, so a change to one class rewrites only that directory.
+// Rows whose class no longer exists go to shards/_unsharded/. New
+// submissions are appended to the shard's assignments.log instead of
+// rewriting assignments.txt (see SUBMISSION INGESTION). Loading replays the
+// log, and the next full write of the shard folds it in and removes it.
+const char* SHARD_ROOT = "shards";
+const char* UNSHARDED = "_unsharded";
+vector<string> dirtyShards;
+
+void makeDirectory(const char* path) {
+#ifdef _WIN32
+    _mkdir(path);
+#else
+    mkdir(path, 0755);
+#endif
 }
 
-void saveAssignments() {
-    ofstream file("assignments.txt");
-    if (!file.is_open()) return;
-    file << assignmentCount << "\n";
-    for (int i = 0; i < assignmentCount; i++) {
-        file << assignments[i].id << ","
-             << assignments[i].studentName << ","
-             << assignments[i].courseName << ","
-             << assignments[i].encryptedSubmission << ","
-             << assignments[i].encryptedGrade << ","
-             << assignments[i].isGraded << ","
-             << assignments[i].signature.signedBy << ","
-             << assignments[i].signature.signatureHash << ","
-             << assignments[i].signature.isVerified << "\n";
-    }
-    file.close();
+// Removes an empty directory.
+void removeDirectory(const char* path) {
+#ifdef _WIN32
+    _rmdir(path);
+#else
+    rmdir(path);
+#endif
 }
 
-void loadAssignments() {
-    ifstream file("assignments.txt");
-    if (!file.is_open()) return;
-    file >> assignmentCount;
-    file.ignore();
-    for (int i = 0; i < assignmentCount; i++) {
-        char line[7000];
-        file.getline(line, 7000);
-        char* token = strtok(line, ",");
-        if (token) strncpy(assignments[i].id, token, 19); assignments[i].id[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(assignments[i].studentName, token, 49); assignments[i].studentName[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(assignments[i].courseName, token, 99); assignments[i].courseName[99] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(assignments[i].encryptedSubmission, token, 4999); assignments[i].encryptedSubmission[4999] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(assignments[i].encryptedGrade, token, 999); assignments[i].encryptedGrade[999] = '\0';
-        token = strtok(NULL, ",");
-        if (token) assignments[i].isGraded = atoi(token);
-        token = strtok(NULL, ",");
-        if (token) strncpy(assignments[i].signature.signedBy, token, 49);
-        token = strtok(NULL, ",");
-        if (token) assignments[i].signature.signatureHash = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) assignments[i].signature.isVerified = atoi(token);
-    }
-    file.close();
+bool changeDirectory(const char* path) {
+#ifdef _WIN32
+    return _chdir(path) == 0;
+#else
+    return chdir(path) == 0;
+#endif
 }
 
-void savemessagesList() {
-    ofstream file("messagesList.txt");
-    if (!file.is_open()) return;
-    file << messageCount << "\n";
-    for (int i = 0; i < messageCount; i++) {
-        file << messagesList[i].id << ","
-             << messagesList[i].from << ","
-             << messagesList[i].to << ","
-             << messagesList[i].encryptedContent << ","
-             << messagesList[i].isRead << ","
-             << messagesList[i].integrityHash << "\n";
-    }
-    file.close();
+void shardPath(char* path, const char* shardId, const char* fileName) {
+    sprintf(path, "%s/%s/%s", SHARD_ROOT, shardId, fileName);
 }
 
-void loadmessagesList() {
-    ifstream file("messagesList.txt");
-    if (!file.is_open()) return;
-    file >> messageCount;
-    file.ignore();
-    for (int i = 0; i < messageCount; i++) {
-        char line[3000];
-        file.getline(line, 3000);
-        char* token = strtok(line, ",");
-        if (token) strncpy(messagesList[i].id, token, 19); messagesList[i].id[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(messagesList[i].from, token, 49); messagesList[i].from[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(messagesList[i].to, token, 49); messagesList[i].to[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(messagesList[i].encryptedContent, token, 1999); messagesList[i].encryptedContent[1999] = '\0';
-        token = strtok(NULL, ",");
-        if (token) messagesList[i].isRead = atoi(token);
-        token = strtok(NULL, ",");
-        if (token) messagesList[i].integrityHash = atoll(token);
-    }
-    file.close();
+void makeShardDirectory(const char* shardId) {
+    char dir[64];
+    sprintf(dir, "%s/%s", SHARD_ROOT, shardId);
+    makeDirectory(SHARD_ROOT);
+    makeDirectory(dir);
 }
 
-void saveRequests() {
+const char* examShard(int examIdx) {
+    return findClass(exams[examIdx].assignedClassId) != -1 ? symbolName(exams[examIdx].assignedClassId) : UNSHARDED;
+}
+
+const char* keyDistShard(int keyIdx) {
+    return findClass(keyDist[keyIdx].classId) != -1 ? symbolName(keyDist[keyIdx].classId) : UNSHARDED;
+}
+
+// The shard index entry behind a shard directory name.
+const ShardRows& shardRowsOf(const char* shardId) {
+    static const ShardRows none = ShardRows();
+    if (strcmp(shardId, UNSHARDED) == 0) return orphanRows;
+    Symbol classId = lookupSymbol(shardId);
+    if (findClass(classId) == -1) return none;
+    return (classId < (int)shardRows.size()) ? shardRows[classId] : none;
+}
+
+// Writers of different tables can mark shards at the same time.
+RWLock dirtyShardsLock = RWLOCK_INIT;
+
+void markShardDirty(const char* shardId) {
+    rwWrite(dirtyShardsLock);
+    bool listed = false;
+    for (int i = 0; i < (int)dirtyShards.size() && !listed; i++) {
+        listed = dirtyShards[i] == shardId;
+    }
+    if (!listed) dirtyShards.push_back(shardId);
+    rwWriteUnlock(dirtyShardsLock);
+}
+
+void writeExamRow(ostream& file, const Exam& e, const ExamPayload& p) {
+    file << symbolName(e.id) << ","
+         << p.title << ","
+         << packCipherColumn(p.encryptedContent) << ","
+         << symbolName(e.teacherName) << ","
+         << symbolName(e.assignedClassId) << ","
+         << p.assignedClassName << ","
+         << e.duration << ","
+         << e.isActive << ","
+         << setSize(e.approvedStudents) << ",";
+    vector<Symbol> approved;
+    setMembers(e.approvedStudents, approved);
+    if (approved.empty()) {
+        file << "NONE";
+    } else {
+        for (int j = 0; j < (int)approved.size(); j++) {
+            file << symbolName(approved[j]);
+            if (j < (int)approved.size() - 1) file << ";";
+        }
+    }
+    file << "," << e.keyDistributed << ","
+         << symbolName(p.signature.signedBy) << ","
+         << p.signature.signatureHash << ","
+         << p.signature.isVerified << ","
+         << p.exam_n << ","
+         << p.exam_e << ","
+         << p.exam_d << ","
+         << p.exam_p << ","
+         << p.exam_q << ","
+         << e.opensAt << ","
+         << e.closesAt << "\n";
+}
+
+void saveExams(const char* shardId) {
+    char path[100];
+    shardPath(path, shardId, "exams.txt");
+    ofstream file(path);
+    if (!file.is_open()) return;
+    vector<int> rows = shardRowsOf(shardId).exams;
+    sort(rows.begin(), rows.end());
+    file << rows.size() << "\n";
+    for (int r = 0; r < (int)rows.size(); r++) writeExamRow(file, exams[rows[r]], examPayloads[rows[r]]);
+    file.close();
+}
+
+bool parseExamRow(string_view line, Exam& e, ExamPayload& p) {
+    string_view cols[21];
+    int colCount = csvSplit(line, cols, 21);
+    if (colCount < 11) return false;
+    e.id = intern(cols[0]);
+    csvCopy(p.title, sizeof(p.title), cols[1]);
+    unpackCipherColumn(cols[2], p.encryptedContent, sizeof(p.encryptedContent));
+    e.teacherName = intern(cols[3]);
+    e.assignedClassId = intern(cols[4]);
+    csvCopy(p.assignedClassName, sizeof(p.assignedClassName), cols[5]);
+    e.duration = csvToInt(cols[6]);
+    e.isActive = csvToInt(cols[7]);
+    e.approvedStudents = SymbolSet();
+    if (cols[9] != "NONE") {
+        CsvCursor list = csvCursor(cols[9]);
+        string_view student;
+        for (int n = csvToInt(cols[8]); n > 0 && csvNextField(list, student, ';'); n--) {
+            setAdd(e.approvedStudents, intern(student));
+        }
+    }
+    e.keyDistributed = csvToInt(cols[10]);
+    if (colCount >= 14) {
+        p.signature.signedBy = intern(cols[11]);
+        p.signature.signatureHash = csvToLL(cols[12]);
+        p.signature.isVerified = csvToInt(cols[13]);
+    }
+    if (colCount >= 19) {
+        p.exam_n = csvToLL(cols[14]);
+        p.exam_e = csvToLL(cols[15]);
+        p.exam_d = csvToLL(cols[16]);
+        p.exam_p = csvToLL(cols[17]);
+        p.exam_q = csvToLL(cols[18]);
+    }
+    e.opensAt = colCount >= 21 ? csvToLL(cols[19]) : 0;
+    e.closesAt = colCount >= 21 ? csvToLL(cols[20]) : 0;
+    return true;
+}
+
+void loadExams(const char* path) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    while (csvNextLine(file, line)) {
+        if (parseExamRow(line, exams.ensure(examCount), examPayloads.ensure(examCount))) examCount++;
+    }
+}
+
+void writeAssignmentRow(ostream& file, const Assignment& a, const AssignmentPayload& p) {
+    file << symbolName(a.id) << ","
+         << symbolName(a.studentName) << ","
+         << symbolName(a.courseName) << ","
+         << packCipherColumn(p.encryptedSubmission) << ","
+         << p.encryptedGrade << ","
+         << a.isGraded << ","
+         << symbolName(p.signature.signedBy) << ","
+         << p.signature.signatureHash << ","
+         << p.signature.isVerified << "\n";
+}
+
+bool parseAssignmentRow(string_view line, Assignment& a, AssignmentPayload& p) {
+    string_view cols[9];
+    if (csvSplit(line, cols, 9) < 9) return false;
+    a.id = intern(cols[0]);
+    a.studentName = intern(cols[1]);
+    a.courseName = intern(cols[2]);
+    unpackCipherColumn(cols[3], p.encryptedSubmission, sizeof(p.encryptedSubmission));
+    csvCopy(p.encryptedGrade, sizeof(p.encryptedGrade), cols[4]);
+    a.isGraded = csvToInt(cols[5]);
+    p.signature.signedBy = intern(cols[6]);
+    p.signature.signatureHash = csvToLL(cols[7]);
+    p.signature.isVerified = csvToInt(cols[8]);
+    return true;
+}
+
+void loadAssignments(const char* path) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    while (csvNextLine(file, line)) {
+        if (parseAssignmentRow(line, assignments.ensure(assignmentCount), assignmentPayloads.ensure(assignmentCount))) assignmentCount++;
+    }
+}
+
+// The log is appended by the ingestion thread and removed by full writes of
+// the shard, which may race; this keeps the two file operations apart.
+Mutex assignmentLogLock = MUTEX_INIT;
+
+void appendAssignmentLog(const char* shardId, const string& rows) {
+    char path[100];
+    makeShardDirectory(shardId);
+    shardPath(path, shardId, "assignments.log");
+    mutexLock(assignmentLogLock);
+    ofstream file(path, ios::app);
+    if (file.is_open()) file << rows;
+    file.close();
+    mutexUnlock(assignmentLogLock);
+}
+
+// Sends append their row to messages.log, reads append an "R,<id>" mark and
+// deletes a "D,<id>" mark, so none of them rewrites messagesList.txt. Loading replays the log over the
+// file; the next full write folds it in and removes it. A full write is
+// queued once MESSAGE_LOG_FOLD entries have piled up.
+const int MESSAGE_LOG_FOLD = 1000;
+const char* MESSAGE_LOG = "messages.log";
+Mutex messageLogLock = MUTEX_INIT;
+atomic<int> messagesLogged(0);   // log entries since the last full write
+
+string messageRow(const Message& m) {
+    return string(symbolName(m.id)) + "," + symbolName(m.from) + "," + symbolName(m.to) + "," +
+           packCipherColumn(m.encryptedContent) + "," + (m.isRead ? "1" : "0") + "," + to_string(m.integrityHash) + "\n";
+}
+
+// Writers hold TABLE_MESSAGES, so every logged entry is in the rewrite that
+// replaces the log.
+void savemessagesList() {
+    ofstream file("messagesList.txt");
+    if (!file.is_open()) return;
+    file << messageCount << "\n";
+    for (int i = 0; i < messageCount; i++) {
+        if (!messagesList.isLive(i)) {
+            file << TOMBSTONE << "\n";
+            continue;
+        }
+        file << messageRow(messagesList[i]);
+    }
+    file.close();
+    mutexLock(messageLogLock);
+    remove(MESSAGE_LOG);
+    messagesLogged = 0;
+    mutexUnlock(messageLogLock);
+}
+
+// Returns true when the log has grown enough to be folded.
+bool appendMessageLog(const string& rows) {
+    mutexLock(messageLogLock);
+    ofstream file(MESSAGE_LOG, ios::app);
+    if (file.is_open()) file << rows;
+    file.close();
+    bool fold = ++messagesLogged >= MESSAGE_LOG_FOLD;
+    if (fold) messagesLogged = 0;
+    mutexUnlock(messageLogLock);
+    return fold;
+}
+
+bool parseMessageRow(string_view line, Message& m) {
+    string_view cols[6];
+    if (csvSplit(line, cols, 6) < 6) return false;
+    m.id = intern(cols[0]);
+    m.from = intern(cols[1]);
+    m.to = intern(cols[2]);
+    unpackCipherColumn(cols[3], m.encryptedContent, sizeof(m.encryptedContent));
+    m.isRead = csvToInt(cols[4]);
+    m.integrityHash = csvToLL(cols[5]);
+    return true;
+}
+
+// A row can be in both the file and the log when a full write overtook its
+// append, so ids already loaded are skipped.
+void loadMessageLog() {
+    string buffer;
+    if (!csvReadFile(MESSAGE_LOG, buffer)) return;
+    unordered_map<Symbol, int> loaded;
+    for (int i = 0; i < messageCount; i++) if (messagesList.isLive(i)) loaded[messagesList[i].id] = i;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    int entries = 0;
+    while (csvNextLine(file, line)) {
+        entries++;
+        string_view cols[2];
+        if (csvSplit(line, cols, 2) == 2 && (cols[0] == "R" || cols[0] == "D")) {
+            unordered_map<Symbol, int>::iterator row = loaded.find(intern(cols[1]));
+            if (row == loaded.end()) continue;
+            if (cols[0] == "R") {
+                messagesList[row->second].isRead = true;
+            } else {
+                freeRow(messagesList, row->second);
+                loaded.erase(row);
+            }
+            continue;
+        }
+        Message& m = messagesList.ensure(messageCount);
+        if (!parseMessageRow(line, m)) continue;
+        if (!loaded.insert(make_pair(m.id, messageCount)).second) continue;
+        messageCount++;
+    }
+    messagesLogged = entries;
+}
+
+void loadmessagesList() {
+    messageCount = 0;
+    clearRows(messagesList);
+    string buffer;
+    if (csvReadFile("messagesList.txt", buffer)) {
+        CsvCursor file = csvCursor(buffer);
+        string_view line;
+        csvNextLine(file, line);  // record count
+        while (csvNextLine(file, line)) {
+            if (line == TOMBSTONE) {
+                loadTombstone(messagesList, messageCount);
+                continue;
+            }
+            if (parseMessageRow(line, messagesList.ensure(messageCount))) messageCount++;
+        }
+    }
+    loadMessageLog();
+    rebuildMailboxes();
+}
+
+void saveRequests() {
     ofstream file("requests.txt");
     if (!file.is_open()) return;
     file << requestCount << "\n";
     for (int i = 0; i < requestCount; i++) {
-        file << requests[i].id << ","
-             << requests[i].studentName << ","
-             << requests[i].examId << ","
+        file << symbolName(requests[i].id) << ","
+             << symbolName(requests[i].studentName) << ","
+             << symbolName(requests[i].examId) << ","
              << requests[i].examTitle << ","
-             << requests[i].teacherName << ","
-             << requests[i].classId << ","
+             << symbolName(requests[i].teacherName) << ","
+             << symbolName(requests[i].classId) << ","
              << requests[i].status << ","
              << requests[i].message << "\n";
     }
@@ -1049,1725 +2735,5272 @@ void saveRequests() {
 }
 
 void loadRequests() {
-    ifstream file("requests.txt");
+    string buffer;
+    if (!csvReadFile("requests.txt", buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    requestCount = 0;
+    clearRows(requests);
+    while (csvNextLine(file, line)) {
+        string_view cols[8];
+        if (csvSplit(line, cols, 8) < 8) continue;
+        AccessRequest& r = requests.ensure(requestCount);
+        r.id = intern(cols[0]);
+        r.studentName = intern(cols[1]);
+        r.examId = intern(cols[2]);
+        csvCopy(r.examTitle, sizeof(r.examTitle), cols[3]);
+        r.teacherName = intern(cols[4]);
+        r.classId = intern(cols[5]);
+        csvCopy(r.status, sizeof(r.status), cols[6]);
+        csvCopy(r.message, sizeof(r.message), cols[7]);
+        requestCount++;
+    }
+}
+
+void writeKeyDistRow(ostream& file, const KeyDistribution& k) {
+    file << symbolName(k.id) << ","
+         << symbolName(k.examId) << ","
+         << k.examTitle << ","
+         << symbolName(k.classId) << ","
+         << k.className << ","
+         << symbolName(k.fromTeacher) << ","
+         << symbolName(k.toStudent) << ","
+         << k.publicKeyE << ","
+         << k.publicKeyN << ","
+         << "0,0,"   // were the primes p and q, sent in the clear
+         << k.isClassWide << ","
+         << (setSize(k.readers) > 0) << ","
+         << setSize(k.readers) << ",";
+    vector<Symbol> readers;
+    setMembers(k.readers, readers);
+    if (readers.empty()) {
+        file << "NONE";
+    } else {
+        for (int j = 0; j < (int)readers.size(); j++) {
+            file << symbolName(readers[j]);
+            if (j < (int)readers.size() - 1) file << ";";
+        }
+    }
+    file << "\n";
+}
+
+void saveKeyDistributions(const char* shardId) {
+    char path[100];
+    shardPath(path, shardId, "keydist.txt");
+    ofstream file(path);
     if (!file.is_open()) return;
-    file >> requestCount;
-    file.ignore();
-    for (int i = 0; i < requestCount; i++) {
-        char line[1000];
-        file.getline(line, 1000);
-        char* token = strtok(line, ",");
-        if (token) strncpy(requests[i].id, token, 19); requests[i].id[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].studentName, token, 49); requests[i].studentName[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].examId, token, 19); requests[i].examId[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].examTitle, token, 99); requests[i].examTitle[99] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].teacherName, token, 49); requests[i].teacherName[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].classId, token, 19); requests[i].classId[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].status, token, 19); requests[i].status[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(requests[i].message, token, 499); requests[i].message[499] = '\0';
+    vector<int> rows = shardRowsOf(shardId).keys;
+    sort(rows.begin(), rows.end());
+    file << rows.size() << "\n";
+    for (int r = 0; r < (int)rows.size(); r++) writeKeyDistRow(file, keyDist[rows[r]]);
+    file.close();
+}
+
+// hadPrimes is set for rows written when p and q were still stored here.
+bool parseKeyDistRow(string_view line, KeyDistribution& k, bool& hadPrimes) {
+    string_view cols[15];
+    int colCount = csvSplit(line, cols, 15);
+    if (colCount < 13) return false;
+    k.id = intern(cols[0]);
+    k.examId = intern(cols[1]);
+    csvCopy(k.examTitle, sizeof(k.examTitle), cols[2]);
+    k.classId = intern(cols[3]);
+    csvCopy(k.className, sizeof(k.className), cols[4]);
+    k.fromTeacher = intern(cols[5]);
+    k.toStudent = intern(cols[6]);
+    k.publicKeyE = csvToLL(cols[7]);
+    k.publicKeyN = csvToLL(cols[8]);
+    hadPrimes = csvToLL(cols[9]) != 0 || csvToLL(cols[10]) != 0;
+    k.isClassWide = csvToInt(cols[11]);
+    k.readers = SymbolSet();
+    if (colCount >= 15) {
+        if (cols[14] != "NONE") {
+            CsvCursor list = csvCursor(cols[14]);
+            string_view reader;
+            for (int n = csvToInt(cols[13]); n > 0 && csvNextField(list, reader, ';'); n--) {
+                setAdd(k.readers, intern(reader));
+            }
+        }
+    } else if (csvToInt(cols[12])) {
+        // Older rows carry one shared read flag; treat it as read by every
+        // recipient at the time of the upgrade.
+        if (!k.isClassWide) {
+            setAdd(k.readers, k.toStudent);
+        } else {
+            int classIdx = findClass(k.classId);
+            if (classIdx != -1) setUnionSorted(k.readers, classes[classIdx].enrolledStudents);
+        }
+    }
+    return true;
+}
+
+vector<Symbol> legacyKeys;   // see wrapLegacyKeys()
+
+void loadKeyDistributions(const char* path) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    while (csvNextLine(file, line)) {
+        bool hadPrimes;
+        if (!parseKeyDistRow(line, keyDist.ensure(keyDistCount), hadPrimes)) continue;
+        if (hadPrimes) legacyKeys.push_back(keyDist[keyDistCount].id);
+        keyDistCount++;
+    }
+}
+
+//  KEY ENVELOPES
+// A key distribution carries only the exam's public key. The private key d
+// is wrapped once per recipient under that student's own RSA public key as
+// whole-number blocks with random padding (see sealSecret()), so only that
+// student's private key opens it. Envelopes are sealed on the
+// executor and appended to the shard's envelopes.txt in one write per
+// distribution. Removing a key row drops its envelopes, and a full write of
+// the shard rewrites the file from its live key rows, so envelopes of deleted
+// keys do not pile up. A student without an envelope (one who joined after
+// the key was sent) can still factor n.
+const int WRAP_GRAIN = 64;   // envelopes per executor task
+
+struct Envelope {
+    Symbol student;
+    long long e, n;          // the student's public key
+    char wrapped[100];
+};
+
+struct WrapJob {
+    long long secret;
+    Envelope* envelopes;
+};
+
+typedef unordered_map<Symbol, string> KeyEnvelopes;   // student -> wrapped d
+unordered_map<Symbol, KeyEnvelopes> keyEnvelopes;    // key id -> its envelopes; under TABLE_KEYDIST
+Mutex envelopeFileLock = MUTEX_INIT;
+atomic<long long> envelopesSealed(0);
+
+const string* findEnvelope(Symbol keyId, Symbol student) {
+    unordered_map<Symbol, KeyEnvelopes>::const_iterator key = keyEnvelopes.find(keyId);
+    if (key == keyEnvelopes.end()) return NULL;
+    KeyEnvelopes::const_iterator found = key->second.find(student);
+    return found != key->second.end() ? &found->second : NULL;
+}
+
+void writeEnvelopeRow(string& rows, Symbol keyId, Symbol student, const string& wrapped) {
+    rows += symbolName(keyId);
+    rows += ",";
+    rows += symbolName(student);
+    rows += ",";
+    rows += wrapped;
+    rows += "\n";
+}
+
+// The secret is cut into limbs of base n / ENVELOPE_PAD, most significant
+// first. Each limb is sealed as the block limb * ENVELOPE_PAD + r with a
+// random r >= 2, so sealing the same secret twice gives different text and
+// no block is 0 or 1.
+const long long ENVELOPE_PAD = 64;
+
+void sealSecret(long long secret, long long e, long long n, char* out) {
+    long long base = n / ENVELOPE_PAD;
+    vector<long long> limbs;
+    do {
+        limbs.push_back(secret % base);
+        secret /= base;
+    } while (secret > 0);
+    for (int i = (int)limbs.size() - 1; i >= 0; i--) {
+        long long block = limbs[i] * ENVELOPE_PAD + 2 + (long long)(randomNext() % (ENVELOPE_PAD - 2));
+        out += sprintf(out, "%lld ", modPow(block, e, n));
+    }
+    *out = '\0';
+}
+
+// Returns -1 when the text is not a sealed secret for this key.
+long long openSecret(const char* wrapped, long long d, long long n) {
+    long long base = n / ENVELOPE_PAD, secret = 0;
+    if (base < 2) return -1;
+    CsvCursor tokens = csvCursor(wrapped);
+    string_view token;
+    int limbs = 0;
+    while (csvNextField(tokens, token, ' ')) {
+        if (token.empty()) continue;
+        if (++limbs > 4) return -1;
+        secret = secret * base + modPow(csvToLL(token), d, n) / ENVELOPE_PAD;
+    }
+    return limbs > 0 ? secret : -1;
+}
+
+void wrapRange(void* arg, int begin, int end) {
+    WrapJob* job = (WrapJob*)arg;
+    for (int i = begin; i < end; i++) {
+        Envelope& envelope = job->envelopes[i];
+        sealSecret(job->secret, envelope.e, envelope.n, envelope.wrapped);
     }
+}
+
+// Seals d for each student with an account and stores the envelopes under
+// key keyId. Returns how many were sealed. Caller holds no TableGuard.
+int wrapExamKey(Symbol keyId, const char* shardId, long long d, const vector<Symbol>& students) {
+    vector<Envelope> envelopes;
+    {
+        TableGuard guard(TABLE_USERS, 0);
+        for (int i = 0; i < (int)students.size(); i++) {
+            int userIdx = findUser(students[i]);
+            if (userIdx == -1) continue;
+            Envelope envelope;
+            envelope.student = students[i];
+            envelope.e = users[userIdx].keys.e;
+            envelope.n = users[userIdx].keys.n;
+            envelopes.push_back(envelope);
+        }
+    }
+    WrapJob job;
+    job.secret = d;
+    job.envelopes = envelopes.data();
+    parallelFor(0, (int)envelopes.size(), WRAP_GRAIN, wrapRange, &job, PRIORITY_BULK);
+
+    // The map is filled before the file is appended, so a full write of the
+    // shard in between already holds these envelopes.
+    string rows;
+    {
+        TableGuard guard(0, TABLE_KEYDIST);
+        KeyEnvelopes& sealed = keyEnvelopes[keyId];
+        for (int i = 0; i < (int)envelopes.size(); i++) {
+            sealed[envelopes[i].student] = envelopes[i].wrapped;
+            writeEnvelopeRow(rows, keyId, envelopes[i].student, envelopes[i].wrapped);
+        }
+    }
+    char path[100];
+    makeShardDirectory(shardId);
+    shardPath(path, shardId, "envelopes.txt");
+    mutexLock(envelopeFileLock);
+    ofstream file(path, ios::app);
+    if (file.is_open()) file << rows;
     file.close();
+    mutexUnlock(envelopeFileLock);
+    envelopesSealed += envelopes.size();
+    return (int)envelopes.size();
 }
 
-void saveKeyDistributions() {
-    ofstream file("keydist.txt");
-    if (!file.is_open()) return;
-    file << keyDistCount << "\n";
+// Loads a shard's envelopes for the key rows loaded from it, which start at
+// firstKeyRow. Returns false when the file holds envelopes of keys that are
+// gone, so the shard should be written again.
+bool loadEnvelopes(const char* path, int firstKeyRow) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return true;
+    unordered_map<Symbol, int> keyRows;
+    for (int i = firstKeyRow; i < keyDistCount; i++) keyRows[keyDist[i].id] = i;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    bool clean = true;
+    while (csvNextLine(file, line)) {
+        string_view cols[3];
+        if (csvSplit(line, cols, 3) < 3) continue;
+        Symbol keyId = lookupSymbol(string(cols[0]).c_str());
+        if (keyRows.find(keyId) == keyRows.end()) {
+            clean = false;
+            continue;
+        }
+        keyEnvelopes[keyId][intern(cols[1])] = string(cols[2]);
+    }
+    return clean;
+}
+
+void saveEnvelopes(const char* shardId) {
+    vector<int> keyRows = shardRowsOf(shardId).keys;
+    sort(keyRows.begin(), keyRows.end());
+    string rows;
+    for (int k = 0; k < (int)keyRows.size(); k++) {
+        Symbol keyId = keyDist[keyRows[k]].id;
+        unordered_map<Symbol, KeyEnvelopes>::const_iterator key = keyEnvelopes.find(keyId);
+        if (key == keyEnvelopes.end()) continue;
+        vector<Symbol> students;
+        for (KeyEnvelopes::const_iterator e = key->second.begin(); e != key->second.end(); ++e) students.push_back(e->first);
+        sort(students.begin(), students.end());
+        for (int i = 0; i < (int)students.size(); i++) writeEnvelopeRow(rows, keyId, students[i], key->second.find(students[i])->second);
+    }
+    char path[100];
+    shardPath(path, shardId, "envelopes.txt");
+    mutexLock(envelopeFileLock);
+    if (rows.empty()) {
+        remove(path);
+    } else {
+        ofstream file(path);
+        if (file.is_open()) file << rows;
+        file.close();
+    }
+    mutexUnlock(envelopeFileLock);
+}
+
+// Opens the student's envelope for the newest key of the exam sent to them
+// and checks the recovered d against the exam's public key (n, e).
+bool unwrapExamKey(Symbol student, Symbol examId, long long& n, long long& e, long long& d) {
+    string wrapped;
+    long long studentD = 0, studentN = 0;
+    {
+        TableGuard guard(TABLE_USERS | TABLE_CLASSES | TABLE_KEYDIST, 0);
+        int userIdx = findUser(student);
+        if (userIdx == -1) return false;
+        studentD = users[userIdx].keys.d;
+        studentN = users[userIdx].keys.n;
+        vector<int> rows;
+        visibleKeys(student, rows);
+        for (int r = (int)rows.size() - 1; r >= 0 && wrapped.empty(); r--) {
+            const KeyDistribution& k = keyDist[rows[r]];
+            if (k.examId != examId) continue;
+            const string* found = findEnvelope(k.id, student);
+            if (found == NULL) continue;
+            wrapped = *found;
+            n = k.publicKeyN;
+            e = k.publicKeyE;
+        }
+    }
+    if (wrapped.empty()) return false;
+    d = openSecret(wrapped.c_str(), studentD, studentN);
+    return d > 0 && n > 2 && modPow(modPow(2, e, n), d, n) == 2;
+}
+
+// Key rows loaded from files that still held p and q. Their recipients get
+// envelopes and the rows are marked so they are written again without them.
+// Exams without a key get no envelopes.
+void wrapLegacyKeys() {
+    sort(legacyKeys.begin(), legacyKeys.end());
     for (int i = 0; i < keyDistCount; i++) {
-        file << keyDist[i].id << ","
-             << keyDist[i].examId << ","
-             << keyDist[i].examTitle << ","
-             << keyDist[i].classId << ","
-             << keyDist[i].className << ","
-             << keyDist[i].fromTeacher << ","
-             << keyDist[i].toStudent << ","
-             << keyDist[i].publicKeyE << ","
-             << keyDist[i].publicKeyN << ","
-             << keyDist[i].p << ","
-             << keyDist[i].q << ","
-             << keyDist[i].isClassWide << ","
-             << keyDist[i].isRead << "\n";
+        if (!keyDist.isLive(i)) continue;
+        if (!binary_search(legacyKeys.begin(), legacyKeys.end(), keyDist[i].id)) continue;
+        markShardDirty(keyDistShard(i));
+        int examIdx = findExam(keyDist[i].examId);
+        if (examIdx == -1 || !hasExamKey(examPayloads[examIdx])) continue;
+        vector<Symbol> students;
+        if (!keyDist[i].isClassWide) {
+            students.push_back(keyDist[i].toStudent);
+        } else {
+            int classIdx = findClass(keyDist[i].classId);
+            if (classIdx != -1) students = classes[classIdx].enrolledStudents;
+        }
+        wrapExamKey(keyDist[i].id, keyDistShard(i), examPayloads[examIdx].exam_d, students);
+    }
+    legacyKeys.clear();
+}
+
+//  SUBMISSION INDEX
+// exam id -> ids of its submissions, persisted per shard in subindex.txt next
+// to assignments.txt. Opening an exam reads only its own submissions, and
+// listings get per-exam counts without scanning assignments[]. Ids, not rows,
+// are stored so row removal does not disturb it.
+vector<vector<Symbol>> examSubmissions;   // indexed by exam Symbol
+
+int submissionCount(Symbol examId) {
+    return (examId >= 0 && examId < (int)examSubmissions.size()) ? (int)examSubmissions[examId].size() : 0;
+}
+
+void indexSubmission(Symbol examId, Symbol submissionId) {
+    if (examId < 0) return;
+    if (examId >= (int)examSubmissions.size()) examSubmissions.resize(examId + 1);
+    examSubmissions[examId].push_back(submissionId);
+}
+
+void rebuildSubmissionIndex() {
+    examSubmissions.clear();
+    for (int i = 0; i < assignmentCount; i++) if (assignments.isLive(i)) indexSubmission(assignments[i].courseName, assignments[i].id);
+}
+
+// The loaded index must name every submission exactly once under its exam;
+// anything else (missing or hand-edited files) falls back to a rebuild.
+bool submissionIndexValid() {
+    int indexed = 0;
+    for (int e = 0; e < (int)examSubmissions.size(); e++) {
+        for (int j = 0; j < (int)examSubmissions[e].size(); j++) {
+            int row = findAssignment(examSubmissions[e][j]);
+            if (row == -1 || assignments[row].courseName != e) return false;
+            indexed++;
+        }
+    }
+    return indexed == liveRows(assignments, assignmentCount);
+}
+
+void writeSubmissionIndexRow(ostream& file, Symbol examId) {
+    const vector<Symbol>& subs = examSubmissions[examId];
+    file << symbolName(examId) << "," << subs.size() << ",";
+    for (int j = 0; j < (int)subs.size(); j++) {
+        file << symbolName(subs[j]);
+        if (j < (int)subs.size() - 1) file << ";";
+    }
+    file << "\n";
+}
+
+// Exams of a shard that have submissions, in row order. Submissions whose
+// exam is gone are kept with the unsharded rows.
+void shardExamIds(const char* shardId, vector<Symbol>& examIds) {
+    vector<int> rows = shardRowsOf(shardId).exams;
+    sort(rows.begin(), rows.end());
+    for (int r = 0; r < (int)rows.size(); r++) {
+        if (submissionCount(exams[rows[r]].id) > 0) examIds.push_back(exams[rows[r]].id);
+    }
+    if (strcmp(shardId, UNSHARDED) == 0) {
+        for (int e = 0; e < (int)examSubmissions.size(); e++) {
+            if (!examSubmissions[e].empty() && findExam(e) == -1) examIds.push_back(e);
+        }
     }
+}
+
+void saveSubmissionIndex(const char* shardId) {
+    char path[100];
+    shardPath(path, shardId, "subindex.txt");
+    ofstream file(path);
+    if (!file.is_open()) return;
+    vector<Symbol> examIds;
+    shardExamIds(shardId, examIds);
+    file << examIds.size() << "\n";
+    for (int i = 0; i < (int)examIds.size(); i++) writeSubmissionIndexRow(file, examIds[i]);
     file.close();
 }
 
-void loadKeyDistributions() {
-    ifstream file("keydist.txt");
+// A shard's submissions are found through its exams' index entries.
+void saveAssignments(const char* shardId) {
+    char path[100];
+    shardPath(path, shardId, "assignments.txt");
+    ofstream file(path);
     if (!file.is_open()) return;
-    file >> keyDistCount;
-    file.ignore();
-    for (int i = 0; i < keyDistCount; i++) {
-        char line[1000];
-        file.getline(line, 1000);
-        char* token = strtok(line, ",");
-        if (token) strncpy(keyDist[i].id, token, 19); keyDist[i].id[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].examId, token, 19); keyDist[i].examId[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].examTitle, token, 99); keyDist[i].examTitle[99] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].classId, token, 19); keyDist[i].classId[19] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].className, token, 99); keyDist[i].className[99] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].fromTeacher, token, 49); keyDist[i].fromTeacher[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) strncpy(keyDist[i].toStudent, token, 49); keyDist[i].toStudent[49] = '\0';
-        token = strtok(NULL, ",");
-        if (token) keyDist[i].publicKeyE = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) keyDist[i].publicKeyN = atoll(token);
-        token = strtok(NULL, ","); if (token) keyDist[i].p = atoll(token);
-        token = strtok(NULL, ","); if (token) keyDist[i].q = atoll(token);
-        token = strtok(NULL, ",");
-        if (token) keyDist[i].isClassWide = atoi(token);
-        token = strtok(NULL, ",");
-        if (token) keyDist[i].isRead = atoi(token);
+    vector<Symbol> examIds;
+    shardExamIds(shardId, examIds);
+    vector<int> rows;
+    for (int e = 0; e < (int)examIds.size(); e++) {
+        const vector<Symbol>& subIds = examSubmissions[examIds[e]];
+        for (int j = 0; j < (int)subIds.size(); j++) {
+            int row = findAssignment(subIds[j]);
+            if (row != -1) rows.push_back(row);
+        }
     }
+    sort(rows.begin(), rows.end());
+    file << rows.size() << "\n";
+    for (int r = 0; r < (int)rows.size(); r++) writeAssignmentRow(file, assignments[rows[r]], assignmentPayloads[rows[r]]);
     file.close();
 }
 
+void loadSubmissionIndex(const char* path) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    csvNextLine(file, line);  // record count
+    while (csvNextLine(file, line)) {
+        string_view cols[3];
+        if (csvSplit(line, cols, 3) < 3) continue;
+        Symbol examId = intern(cols[0]);
+        CsvCursor list = csvCursor(cols[2]);
+        string_view subId;
+        for (int n = csvToInt(cols[1]); n > 0 && csvNextField(list, subId, ';'); n--) {
+            indexSubmission(examId, intern(subId));
+        }
+    }
+}
+
+// Replays a shard's log over the rows loaded from its assignments.txt, which
+// start at firstRow. A row can be in both when a full write overtook its
+// append, so rows already loaded are skipped. Logged rows are missing from
+// subindex.txt and are indexed here.
+void loadAssignmentLog(const char* path, int firstRow) {
+    string buffer;
+    if (!csvReadFile(path, buffer)) return;
+    unordered_map<Symbol, int> loaded;
+    for (int i = firstRow; i < assignmentCount; i++) loaded[assignments[i].id] = i;
+    CsvCursor file = csvCursor(buffer);
+    string_view line;
+    while (csvNextLine(file, line)) {
+        Assignment& a = assignments.ensure(assignmentCount);
+        if (!parseAssignmentRow(line, a, assignmentPayloads.ensure(assignmentCount))) continue;
+        if (!loaded.insert(make_pair(a.id, assignmentCount)).second) continue;
+        indexSubmission(a.courseName, a.id);
+        assignmentCount++;
+    }
+}
+
+// Other threads cannot add rows while this runs (the writer thread holds
+// TABLE_ASSIGNMENTS), so every logged row is in the rewrite that replaces the log.
+void saveShard(const char* shardId) {
+    char path[100];
+    makeShardDirectory(shardId);
+    saveExams(shardId);
+    saveAssignments(shardId);
+    saveKeyDistributions(shardId);
+    saveEnvelopes(shardId);
+    saveSubmissionIndex(shardId);
+    shardPath(path, shardId, "assignments.log");
+    mutexLock(assignmentLogLock);
+    remove(path);
+    mutexUnlock(assignmentLogLock);
+}
+
+void loadShard(const char* shardId) {
+    char path[100];
+    shardPath(path, shardId, "exams.txt");
+    loadExams(path);
+    int firstAssignment = assignmentCount;
+    shardPath(path, shardId, "assignments.txt");
+    loadAssignments(path);
+    int firstKey = keyDistCount;
+    shardPath(path, shardId, "keydist.txt");
+    loadKeyDistributions(path);
+    shardPath(path, shardId, "envelopes.txt");
+    if (!loadEnvelopes(path, firstKey)) markShardDirty(shardId);
+    shardPath(path, shardId, "subindex.txt");
+    loadSubmissionIndex(path);
+    shardPath(path, shardId, "assignments.log");
+    loadAssignmentLog(path, firstAssignment);
+}
+
+void saveDirtyShards() {
+    vector<string> shards;
+    rwWrite(dirtyShardsLock);
+    shards.swap(dirtyShards);
+    rwWriteUnlock(dirtyShardsLock);
+    for (int i = 0; i < (int)shards.size(); i++) {
+        saveShard(shards[i].c_str());
+    }
+}
+
+void markAllShardsDirty() {
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i)) markShardDirty(symbolName(classes[i].classId));
+    markShardDirty(UNSHARDED);
+}
+
+// Files from before sharding are split into shards once, then removed.
+bool migrateUnshardedFiles() {
+    ifstream legacy("exams.txt");
+    if (!legacy.is_open()) return false;
+    legacy.close();
+    loadExams("exams.txt");
+    loadAssignments("assignments.txt");
+    loadKeyDistributions("keydist.txt");
+    rebuildIndexes();
+    rebuildSubmissionIndex();
+    markAllShardsDirty();
+    saveDirtyShards();
+    remove("exams.txt");
+    remove("assignments.txt");
+    remove("keydist.txt");
+    return true;
+}
+
 void loadAllData() {
     loadUsers();
     loadClasses();
-    loadExams();
-    loadAssignments();
+    rebuildIndexes();
+    examCount = 0;
+    assignmentCount = 0;
+    keyDistCount = 0;
+    clearRows(exams);
+    clearRows(assignments);
+    clearRows(keyDist);
+    examSubmissions.clear();
+    keyEnvelopes.clear();
+    legacyKeys.clear();
+    if (!migrateUnshardedFiles()) {
+        for (int i = 0; i < classCount; i++) if (classes.isLive(i)) loadShard(symbolName(classes[i].classId));
+        loadShard(UNSHARDED);
+    }
     loadmessagesList();
     loadRequests();
-    loadKeyDistributions();
+    rebuildIndexes();
+    if (!submissionIndexValid()) {
+        rebuildSubmissionIndex();
+        markAllShardsDirty();
+        saveDirtyShards();
+    }
+    if (!legacyKeys.empty()) {
+        wrapLegacyKeys();
+        saveDirtyShards();
+    }
 }
 
 void saveAllData() {
     saveUsers();
     saveClasses();
-    saveExams();
-    saveAssignments();
+    markAllShardsDirty();
+    saveDirtyShards();
     savemessagesList();
     saveRequests();
-    saveKeyDistributions();
 }
 
-// NEW FEATURE: VIEW RSA KEY INFO 
-void viewMyKeyInfo() {
-    clearScreen();
-    displayRSABanner();
-    displayHeader("MY RSA KEY INFORMATION");
-    
-    int userIdx = findUser(currentUser);
-    if (userIdx == -1) {
-        drawBoxTop();
-        drawBoxLine("Error: User not found!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
-    }
-    
-    RSAKeys& keys = users[userIdx].keys;
-    
-    drawBoxTop();
-    drawBoxLine("=== YOUR RSA KEYS ===", BOX_WIDTH, COLOR_HEADER);
-    drawBoxMiddle();
-    
-    char buffer[100];
-    
-    drawBoxLineLeft("PUBLIC KEY (Share this):", BOX_WIDTH, COLOR_SUCCESS);
-    sprintf(buffer, "  e = %lld", keys.e);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    sprintf(buffer, "  n = %lld", keys.n);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    
-    drawBoxMiddle();
-    
-    drawBoxLineLeft("PRIVATE KEY (Keep secret!):", BOX_WIDTH, COLOR_ERROR);
-    sprintf(buffer, "  d = %lld", keys.d);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    
-    drawBoxMiddle();
-    
-    drawBoxLineLeft("KEY GENERATION PARAMETERS:", BOX_WIDTH, COLOR_HEADER);
-    sprintf(buffer, "  Prime p = %lld", keys.p);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    sprintf(buffer, "  Prime q = %lld", keys.q);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    sprintf(buffer, "  phi(n) = %lld", keys.phi);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    sprintf(buffer, "  n = p * q = %lld", keys.n);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    
-    drawBoxMiddle();
-    
-    // Verify key correctness
-    bool valid = (keys.n == keys.p * keys.q) && 
-                 (keys.phi == (keys.p - 1) * (keys.q - 1)) &&
-                 (gcd(keys.e, keys.phi) == 1) &&
-                 ((keys.e * keys.d) % keys.phi == 1);
-    
-    if (valid) {
-        drawBoxLine("KEY VERIFICATION: VALID", BOX_WIDTH, COLOR_SUCCESS);
-    } else {
-        drawBoxLine("KEY VERIFICATION: INVALID", BOX_WIDTH, COLOR_ERROR);
+//  PERSISTENCE THREAD
+// Mutations do not rewrite files themselves. They set bits in pendingSaves
+// (shards are also listed with markShardDirty) and wake the writer thread.
+// The writer takes shared locks, writes each file whose bit is set and clears
+// the bits, so a burst of changes becomes one write per file. An operation
+// that must be on disk before it is acknowledged calls flushPersistence(),
+// which waits for a write pass that started after its change. Never call it
+// while holding a TableGuard, because the writer needs those locks.
+enum SaveBit { SAVE_USERS = 1, SAVE_CLASSES = 2, SAVE_SHARDS = 4, SAVE_MESSAGES = 8, SAVE_REQUESTS = 16 };
+const int PERSIST_IDLE_MS = 1000;
+
+atomic<unsigned> pendingSaves(0);
+atomic<long long> persistRequests(0);   // persistAsync() calls so far
+atomic<long long> savePasses(0);     // write passes that found work
+long long savesCompleted = 0;        // persistRequests covered by the last pass; under persistMutex
+Mutex persistMutex = MUTEX_INIT;
+Condition persistWake = CONDITION_INIT;
+Condition persistDone = CONDITION_INIT;
+bool persistStop = false;
+bool persistRunning = false;
+ThreadHandle persistThread;
+
+void persistAsync(unsigned bits) {
+    pendingSaves |= bits;
+    persistRequests++;
+    mutexLock(persistMutex);
+    conditionWakeAll(persistWake);
+    mutexUnlock(persistMutex);
+}
+
+void writePendingSaves() {
+    long long covered = persistRequests;   // every request up to here has set its bits
+    unsigned bits = pendingSaves.exchange(0);
+    if (bits != 0) {
+        int reads = 0;
+        if (bits & SAVE_USERS) reads |= TABLE_USERS;
+        if (bits & SAVE_CLASSES) reads |= TABLE_CLASSES;
+        if (bits & SAVE_SHARDS) reads |= TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS | TABLE_KEYDIST;
+        if (bits & SAVE_MESSAGES) reads |= TABLE_MESSAGES;
+        if (bits & SAVE_REQUESTS) reads |= TABLE_REQUESTS;
+        TableGuard guard(reads, 0);
+        if (bits & SAVE_USERS) saveUsers();
+        if (bits & SAVE_CLASSES) saveClasses();
+        if (bits & SAVE_SHARDS) saveDirtyShards();
+        if (bits & SAVE_MESSAGES) savemessagesList();
+        if (bits & SAVE_REQUESTS) saveRequests();
+        savePasses++;
     }
-    
-    drawBoxBottom();
-    
-    cout << endl;
-    drawBoxTop(50);
-    drawBoxLine("RSA FORMULA REFERENCE", 50, COLOR_HEADER);
-    drawBoxMiddle(50);
-    drawBoxLineLeft("Encrypt: C = M^e mod n", 50, COLOR_INFO);
-    drawBoxLineLeft("Decrypt: M = C^d mod n", 50, COLOR_INFO);
-    drawBoxLineLeft("Sign:    S = H^d mod n", 50, COLOR_INFO);
-    drawBoxLineLeft("Verify:  H = S^e mod n", 50, COLOR_INFO);
-    drawBoxBottom(50);
-    
-    pauseScreen();
+    mutexLock(persistMutex);
+    if (covered > savesCompleted) savesCompleted = covered;
+    conditionWakeAll(persistDone);
+    mutexUnlock(persistMutex);
 }
 
-//NEW FEATURE: RSA ENCRYPTION DEMO 
+THREAD_MAIN(persistenceMain) {
+    (void)arg;
+    mutexLock(persistMutex);
+    while (true) {
+        while (!persistStop && pendingSaves == 0) conditionWait(persistWake, persistMutex, PERSIST_IDLE_MS);
+        bool stopping = persistStop;
+        mutexUnlock(persistMutex);
+        writePendingSaves();
+        mutexLock(persistMutex);
+        if (stopping && pendingSaves == 0) break;
+    }
+    mutexUnlock(persistMutex);
+    return 0;
+}
+
+// Blocks until every change made before the call is on disk.
+void flushPersistence() {
+    long long target = persistRequests;
+    if (!persistRunning) {
+        writePendingSaves();
+        return;
+    }
+    mutexLock(persistMutex);
+    conditionWakeAll(persistWake);
+    while (savesCompleted < target) conditionWait(persistDone, persistMutex, PERSIST_IDLE_MS);
+    mutexUnlock(persistMutex);
+}
+
+void startPersistence() {
+    persistStop = false;
+    persistRunning = startThread(persistThread, persistenceMain, NULL);
+}
+
+// Writes whatever is still pending and joins the writer.
+void stopPersistence() {
+    if (!persistRunning) {
+        writePendingSaves();
+        return;
+    }
+    mutexLock(persistMutex);
+    persistStop = true;
+    conditionWakeAll(persistWake);
+    mutexUnlock(persistMutex);
+    joinThread(persistThread);
+    persistRunning = false;
+}
+
+//  SUBMISSION INGESTION
+// Submissions are pushed onto a lock-free queue by any thread: the console,
+// server sessions and the timer thread at a deadline. One ingestion thread
+// takes everything queued as a batch and has the executor encrypt and sign
+// it. While that runs it commits the previous batch: one write lock to add
+// the rows, then one append per shard to assignments.log. A burst becomes a
+// few large commits, and no submission rewrites assignments.txt. Each one is
+// acknowledged once its log append is done.
+const int SEAL_GRAIN = 4;          // submissions per sealing task
+const int INGEST_IDLE_MS = 1000;
+
+enum SubmitNotify {
+    NOTIFY_NONE,      // nobody waits; freed after commit
+    NOTIFY_WAITER,    // a thread waits in submitAnswer()
+    NOTIFY_SESSION    // handed to the server through finishedSubmits
+};
+
+struct Submission {
+    Symbol student;
+    Symbol examId;
+    string answer;
+    long long e, n, d;
+    SubmitNotify notify;
+    int sessionId;               // NOTIFY_SESSION only
+    long long queuedMs;
+    Assignment record;           // filled when sealed
+    AssignmentPayload payload;
+    string logRow;
+    bool stored;                 // false if the exam was gone at commit
+    bool committed;              // under ingestLock
+    Submission* next;            // queue link
+};
+
+atomic<Submission*> submitQueue(NULL);   // newest first
+vector<Submission*> finishedSubmits;     // under ingestLock
+Mutex ingestLock = MUTEX_INIT;
+Condition ingestWake = CONDITION_INIT;
+Condition ingestCommitted = CONDITION_INIT;
+bool ingestStop = false;
+bool ingestRunning = false;
+ThreadHandle ingestThread;
+atomic<long long> submissionsCommitted(0);
+atomic<long long> submitBatches(0);
+atomic<long long> peakSubmitRate(0);     // most commits in one second
+long long rateSecond = 0, rateCount = 0; // ingestion thread only
+LatencyHistogram submitLatency;          // queued to on disk
+
+// Encrypts each answer with the exam's public key (e, n) so only the teacher
+// can read it, and signs it with the private key d the student recovered.
+// The row is formatted for the log here too, off the commit path.
+void sealRange(void* arg, int begin, int end) {
+    Submission** batch = (Submission**)arg;
+    for (int i = begin; i < end; i++) {
+        Submission* s = batch[i];
+        encryptMessage(s->answer.c_str(), s->payload.encryptedSubmission, s->e, s->n, PRIORITY_BULK);
+        s->payload.signature.signedBy = s->student;
+        s->payload.signature.signatureHash = createSignature(s->answer.c_str(), s->d, s->n);
+        s->payload.signature.isVerified = true;
+        s->record.id = generateId("SUB");
+        s->record.studentName = s->student;
+        s->record.courseName = s->examId;
+        s->record.isGraded = false;
+        ostringstream row;
+        writeAssignmentRow(row, s->record, s->payload);
+        s->logRow = row.str();
+    }
+}
+
+// Queues the batch's sealing on the executor; waitGroup(group) finishes it.
+void startSealing(vector<Submission*>& batch, TaskGroup& group) {
+    int count = (int)batch.size();
+    if (workerCount == 0) {
+        sealRange(batch.data(), 0, count);
+        return;
+    }
+    for (int begin = 0; begin < count; begin += SEAL_GRAIN) {
+        Task task = {sealRange, batch.data(), begin, min(begin + SEAL_GRAIN, count), &group};
+        pushTask(task, PRIORITY_BULK);
+    }
+    wakeWorkers();
+}
+
+void commitSubmissions(vector<Submission*>& batch) {
+    if (batch.empty()) return;
+    vector<string> shards(batch.size());
+    {
+        TableGuard guard(TABLE_CLASSES | TABLE_EXAMS | TABLE_KEYDIST, TABLE_ASSIGNMENTS);
+        for (int i = 0; i < (int)batch.size(); i++) {
+            Submission* s = batch[i];
+            int examIdx = findExam(s->examId);
+            s->stored = examIdx != -1;
+            if (!s->stored) continue;
+            int row = allocRow(assignments, assignmentCount);
+            assignments[row] = s->record;
+            assignmentPayloads.ensure(row) = s->payload;
+            indexSet(assignmentIndex, s->record.id, row);
+            indexSubmission(s->examId, s->record.id);
+            shards[i] = examShard(examIdx);
+        }
+    }
+    unordered_map<string, string> logs;
+    for (int i = 0; i < (int)batch.size(); i++) {
+        if (batch[i]->stored) logs[shards[i]] += batch[i]->logRow;
+    }
+    for (unordered_map<string, string>::iterator it = logs.begin(); it != logs.end(); ++it) {
+        appendAssignmentLog(it->first.c_str(), it->second);
+    }
+
+    long long now = monotonicMs();
+    if (now / 1000 != rateSecond) {
+        rateSecond = now / 1000;
+        rateCount = 0;
+    }
+    rateCount += batch.size();
+    if (rateCount > peakSubmitRate) peakSubmitRate = rateCount;
+    submissionsCommitted += batch.size();
+    submitBatches++;
+    mutexLock(ingestLock);
+    for (int i = 0; i < (int)batch.size(); i++) {
+        Submission* s = batch[i];
+        recordLatency(submitLatency, now - s->queuedMs);
+        if (s->notify == NOTIFY_NONE) delete s;
+        else if (s->notify == NOTIFY_SESSION) finishedSubmits.push_back(s);
+        else s->committed = true;
+    }
+    conditionWakeAll(ingestCommitted);
+    mutexUnlock(ingestLock);
+    batch.clear();
+}
+
+// Everything queued so far, oldest first.
+void takeSubmissions(vector<Submission*>& batch) {
+    Submission* list = submitQueue.exchange(NULL);
+    for (; list != NULL; list = list->next) batch.push_back(list);
+    reverse(batch.begin(), batch.end());
+}
+
+THREAD_MAIN(ingestMain) {
+    (void)arg;
+    vector<Submission*> sealed;
+    while (true) {
+        // Only wait when there is nothing sealed to commit.
+        mutexLock(ingestLock);
+        while (!ingestStop && sealed.empty() && submitQueue.load() == NULL) {
+            conditionWait(ingestWake, ingestLock, INGEST_IDLE_MS);
+        }
+        bool stopping = ingestStop;
+        mutexUnlock(ingestLock);
+        vector<Submission*> batch;
+        takeSubmissions(batch);
+        if (stopping && batch.empty() && sealed.empty()) break;
+        TaskGroup sealing(NULL);
+        startSealing(batch, sealing);
+        commitSubmissions(sealed);
+        waitGroup(sealing);
+        sealed.swap(batch);
+    }
+    return 0;
+}
+
+Submission* newSubmission(Symbol student, Symbol examId, const char* answer, long long e, long long n, long long d) {
+    Submission* s = new Submission();
+    s->student = student;
+    s->examId = examId;
+    s->answer = answer;
+    s->e = e;
+    s->n = n;
+    s->d = d;
+    s->notify = NOTIFY_NONE;
+    s->sessionId = -1;
+    return s;
+}
+
+// Hands a submission to the pipeline; see SubmitNotify for who frees it.
+// Without the ingestion thread it is sealed and committed on the caller.
+void queueSubmission(Submission* s) {
+    s->queuedMs = monotonicMs();
+    if (!ingestRunning) {
+        vector<Submission*> batch(1, s);
+        parallelFor(0, 1, 1, sealRange, batch.data(), PRIORITY_BULK);
+        commitSubmissions(batch);
+        return;
+    }
+    Submission* head = submitQueue.load();
+    do {
+        s->next = head;
+    } while (!submitQueue.compare_exchange_weak(head, s));
+    // Only the push onto an empty queue needs to wake the thread.
+    if (head == NULL) {
+        mutexLock(ingestLock);
+        conditionWakeAll(ingestWake);
+        mutexUnlock(ingestLock);
+    }
+}
+
+// Submits one answer and waits until it is on disk. Returns the new
+// submission id, or NO_SYMBOL if the exam no longer exists.
+Symbol submitAnswer(Symbol student, Symbol examId, const char* answer, long long e, long long n, long long d) {
+    Submission* s = newSubmission(student, examId, answer, e, n, d);
+    s->notify = NOTIFY_WAITER;
+    queueSubmission(s);
+    mutexLock(ingestLock);
+    while (!s->committed) conditionWait(ingestCommitted, ingestLock, INGEST_IDLE_MS);
+    mutexUnlock(ingestLock);
+    Symbol id = s->stored ? s->record.id : NO_SYMBOL;
+    delete s;
+    return id;
+}
+
+void startIngestion() {
+    ingestStop = false;
+    ingestRunning = startThread(ingestThread, ingestMain, NULL);
+}
+
+// Commits everything queued and joins the thread.
+void stopIngestion() {
+    if (!ingestRunning) return;
+    mutexLock(ingestLock);
+    ingestStop = true;
+    conditionWakeAll(ingestWake);
+    mutexUnlock(ingestLock);
+    joinThread(ingestThread);
+    ingestRunning = false;
+}
+
+//  ARCHIVE (COLD TIER)
+// Inactive exams and classes leave the in-memory tables and are appended to
+// archive.txt together with their submissions and key distributions, so the
+// hot tables (and every scan over them) only hold live records. Ciphertext
+// stays packed by the column codec. The archive is only read when a teacher
+// opens it from the Archive menu.
+const char* ARCHIVE_FILE = "archive.txt";
+
+// Removed rows go back on their table's free list; callers rebuild the row
+// indexes once the whole batch is gone.
+void removeAssignmentAt(int idx) {
+    freeRow(assignments, idx);
+    assignmentPayloads[idx] = AssignmentPayload();
+}
+
+void removeKeyDistAt(int idx) {
+    keyEnvelopes.erase(keyDist[idx].id);
+    freeRow(keyDist, idx);
+}
+
+void removeExamAt(int idx) {
+    freeRow(exams, idx);
+    examPayloads[idx] = ExamPayload();
+}
+
+void removeClassAt(int idx) {
+    freeRow(classes, idx);
+}
+
+void removeShardFiles(const char* shardId) {
+    rwWrite(dirtyShardsLock);
+    for (int i = 0; i < (int)dirtyShards.size(); i++) {
+        if (dirtyShards[i] == shardId) {
+            dirtyShards.erase(dirtyShards.begin() + i);
+            break;
+        }
+    }
+    rwWriteUnlock(dirtyShardsLock);
+    char path[100];
+    shardPath(path, shardId, "exams.txt");
+    remove(path);
+    shardPath(path, shardId, "assignments.txt");
+    remove(path);
+    shardPath(path, shardId, "keydist.txt");
+    remove(path);
+    shardPath(path, shardId, "envelopes.txt");
+    remove(path);
+    shardPath(path, shardId, "subindex.txt");
+    remove(path);
+    shardPath(path, shardId, "assignments.log");
+    remove(path);
+    sprintf(path, "%s/%s", SHARD_ROOT, shardId);
+#ifdef _WIN32
+    _rmdir(path);
+#else
+    rmdir(path);
+#endif
+}
+
+// Drops an exam with its submissions and key distributions. Submissions are
+// found through the submission index and keys through the shard index, whose
+// entries may still list rows freed earlier in the same batch.
+void dropExam(int examIdx) {
+    Symbol examId = exams[examIdx].id;
+    markShardDirty(examShard(examIdx));
+    if (examId < (int)examSubmissions.size()) {
+        const vector<Symbol>& subIds = examSubmissions[examId];
+        for (int j = 0; j < (int)subIds.size(); j++) {
+            int row = findAssignment(subIds[j]);
+            if (row != -1 && assignments.isLive(row)) removeAssignmentAt(row);
+        }
+        examSubmissions[examId].clear();
+    }
+    vector<int> keyRows = rowsOfClass(exams[examIdx].assignedClassId).keys;
+    for (int k = 0; k < (int)keyRows.size(); k++) {
+        int row = keyRows[k];
+        if (keyDist.isLive(row) && keyDist[row].examId == examId) removeKeyDistAt(row);
+    }
+    int classIdx = findClass(exams[examIdx].assignedClassId);
+    if (classIdx != -1) {
+        Classroom& c = classes[classIdx];
+        for (int j = 0; j < (int)c.assignedExams.size(); j++) {
+            if (c.assignedExams[j] == examId) {
+                c.assignedExams.erase(c.assignedExams.begin() + j);
+                break;
+            }
+        }
+    }
+    removeExamAt(examIdx);
+}
+
+// Drops a class, everything filed under it and its shard directory.
+void dropClass(int classIdx) {
+    Symbol classId = classes[classIdx].classId;
+    vector<int> examRows = rowsOfClass(classId).exams;
+    for (int r = 0; r < (int)examRows.size(); r++) {
+        if (exams.isLive(examRows[r])) dropExam(examRows[r]);
+    }
+    vector<int> keyRows = rowsOfClass(classId).keys;
+    for (int k = 0; k < (int)keyRows.size(); k++) {
+        if (keyDist.isLive(keyRows[k])) removeKeyDistAt(keyRows[k]);
+    }
+    removeClassAt(classIdx);
+    removeShardFiles(symbolName(classId));
+}
+
+// Like dropExam(), the rows come from the submission and shard indexes and
+// are written in row order.
+void archiveExam(int examIdx, ostream& archive) {
+    Symbol examId = exams[examIdx].id;
+    archive << "EXAM,";
+    writeExamRow(archive, exams[examIdx], examPayloads[examIdx]);
+    vector<int> subRows;
+    if (examId < (int)examSubmissions.size()) {
+        const vector<Symbol>& subIds = examSubmissions[examId];
+        for (int j = 0; j < (int)subIds.size(); j++) {
+            int row = findAssignment(subIds[j]);
+            if (row != -1 && assignments.isLive(row)) subRows.push_back(row);
+        }
+    }
+    sort(subRows.begin(), subRows.end());
+    for (int r = 0; r < (int)subRows.size(); r++) {
+        archive << "SUB,";
+        writeAssignmentRow(archive, assignments[subRows[r]], assignmentPayloads[subRows[r]]);
+    }
+    vector<int> keyRows = rowsOfClass(exams[examIdx].assignedClassId).keys;
+    sort(keyRows.begin(), keyRows.end());
+    for (int k = 0; k < (int)keyRows.size(); k++) {
+        int row = keyRows[k];
+        if (!keyDist.isLive(row) || keyDist[row].examId != examId) continue;
+        archive << "KEY,";
+        writeKeyDistRow(archive, keyDist[row]);
+    }
+    dropExam(examIdx);
+}
+
+void archiveClass(int classIdx, ostream& archive) {
+    Symbol classId = classes[classIdx].classId;
+    vector<int> examRows = rowsOfClass(classId).exams;
+    sort(examRows.begin(), examRows.end());
+    for (int r = 0; r < (int)examRows.size(); r++) {
+        if (exams.isLive(examRows[r])) archiveExam(examRows[r], archive);
+    }
+    // Keys can outlive their exam; they still belong to this class's shard.
+    vector<int> keyRows = rowsOfClass(classId).keys;
+    sort(keyRows.begin(), keyRows.end());
+    for (int k = 0; k < (int)keyRows.size(); k++) {
+        if (!keyDist.isLive(keyRows[k])) continue;
+        archive << "KEY,";
+        writeKeyDistRow(archive, keyDist[keyRows[k]]);
+    }
+    archive << "CLASS,";
+    writeClassRow(archive, classes[classIdx]);
+    dropClass(classIdx);
+}
+
+// Moves every inactive class and exam still in the hot tables to the archive.
+int archiveInactiveRecords() {
+    TableGuard guard(0, TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS | TABLE_KEYDIST);
+    int inactive = 0;
+    for (int i = 0; i < classCount; i++) if (classes.isLive(i) && !classes[i].isActive) inactive++;
+    for (int i = 0; i < examCount; i++) if (exams.isLive(i) && !exams[i].isActive) inactive++;
+    if (inactive == 0) return 0;
+
+    ofstream archive(ARCHIVE_FILE, ios::app);
+    if (!archive.is_open()) return 0;
+    for (int i = 0; i < classCount; i++) {
+        if (!classes.isLive(i)) continue;
+        if (!classes[i].isActive) archiveClass(i, archive);
+    }
+    for (int i = 0; i < examCount; i++) {
+        if (!exams.isLive(i)) continue;
+        if (!exams[i].isActive) archiveExam(i, archive);
+    }
+    archive.close();
+    rebuildIndexes();
+
+    persistAsync(SAVE_CLASSES | SAVE_SHARDS);
+    return inactive;
+}
+
+void viewArchivedExams() {
+    clearScreen();
+    displayExamBanner();
+    displayHeader("ARCHIVED EXAMS");
+
+    vector<Exam> archivedExams;
+    vector<ExamPayload> archivedExamPayloads;
+    vector<Assignment> archivedSubs;
+    vector<AssignmentPayload> archivedSubPayloads;
+    string buffer;
+    if (csvReadFile(ARCHIVE_FILE, buffer)) {
+        CsvCursor file = csvCursor(buffer);
+        string_view line;
+        while (csvNextLine(file, line)) {
+            size_t comma = line.find(',');
+            if (comma == string_view::npos) continue;
+            string_view kind = line.substr(0, comma);
+            string_view row = line.substr(comma + 1);
+            if (kind == "EXAM") {
+                Exam e = Exam();
+                ExamPayload p = ExamPayload();
+                if (parseExamRow(row, e, p) && e.teacherName == currentUserSym) {
+                    archivedExams.push_back(e);
+                    archivedExamPayloads.push_back(p);
+                }
+            } else if (kind == "SUB") {
+                Assignment a = Assignment();
+                AssignmentPayload p = AssignmentPayload();
+                if (parseAssignmentRow(row, a, p)) {
+                    archivedSubs.push_back(a);
+                    archivedSubPayloads.push_back(p);
+                }
+            }
+        }
+    }
+
+    if (archivedExams.empty()) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("No archived exams", BOX_WIDTH, COLOR_INFO);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    const char* headers[] = {"ID", "Title", "Class", "Submissions"};
+    int colWidths[] = {10, 22, 14, 13};
+    int totalWidth = 64;
+    cout << endl;
+    drawTableHeader(headers, 4, colWidths, totalWidth);
+    for (int i = 0; i < (int)archivedExams.size(); i++) {
+        int subs = 0;
+        for (int j = 0; j < (int)archivedSubs.size(); j++) {
+            if (archivedSubs[j].courseName == archivedExams[i].id) subs++;
+        }
+        char subStr[15];
+        sprintf(subStr, "%d", subs);
+        const char* row[] = {symbolName(archivedExams[i].id), archivedExamPayloads[i].title, archivedExamPayloads[i].assignedClassName, subStr};
+        drawTableRow(row, 4, colWidths, totalWidth);
+    }
+    drawTableBottom(4, colWidths, totalWidth);
+
+    char examId[20];
+    setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID to view responses (blank to go back): "; resetColor();
+    cin.getline(examId, 20);
+    if (strlen(examId) == 0) return;
+
+    int eIdx = -1;
+    for (int i = 0; i < (int)archivedExams.size(); i++) {
+        if (strcmp(symbolName(archivedExams[i].id), examId) == 0) eIdx = i;
+    }
+    if (eIdx == -1) {
+        drawBoxTop();
+        drawBoxLine("[!] Exam not found in archive!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    if (!hasExamKey(archivedExamPayloads[eIdx])) {
+        drawBoxTop();
+        drawBoxLine("[!] This exam has no key; its answers cannot be decrypted.", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    bool foundSub = false;
+    for (int i = 0; i < (int)archivedSubs.size(); i++) {
+        if (archivedSubs[i].courseName != archivedExams[eIdx].id) continue;
+        foundSub = true;
+        char decryptedAnswer[5000];
+        decryptMessage(archivedSubPayloads[i].encryptedSubmission, decryptedAnswer,
+                       archivedExamPayloads[eIdx].exam_d, archivedExamPayloads[eIdx].exam_n);
+        cout << endl;
+        drawBoxTop();
+        char header[100];
+        sprintf(header, "Student: %s", symbolName(archivedSubs[i].studentName));
+        drawBoxLine(header, BOX_WIDTH, COLOR_HEADER);
+        drawBoxMiddle();
+        setColor(COLOR_SUCCESS);
+        cout << "                                                    " << decryptedAnswer << endl;
+        resetColor();
+        drawBoxBottom();
+    }
+    if (!foundSub) {
+        cout << "\n                                                    No submissions were archived for this exam.\n";
+    }
+    pauseScreen();
+}
+
+bool confirmDelete() {
+    char answer[10];
+    setColor(COLOR_ERROR); cout << "                                                    This cannot be undone. Delete? (y/n): "; resetColor();
+    cin.getline(answer, 10);
+    return answer[0] == 'y' || answer[0] == 'Y';
+}
+
+void archiveMenu() {
+    clearScreen();
+    displayExamBanner();
+    displayHeader("ARCHIVE");
+
+    drawBoxTop(50);
+    drawBoxLine("Archive Options", 50, COLOR_HEADER);
+    drawBoxMiddle(50);
+    drawBoxLineLeft("1. Archive an exam", 50, COLOR_INFO);
+    drawBoxLineLeft("2. Archive a class and its exams", 50, COLOR_INFO);
+    drawBoxLineLeft("3. View archived exams", 50, COLOR_INFO);
+    drawBoxLineLeft("4. Permanently delete an exam", 50, COLOR_ERROR);
+    drawBoxLineLeft("5. Permanently delete a class", 50, COLOR_ERROR);
+    drawBoxLineLeft("0. Back", 50, COLOR_DEFAULT);
+    drawBoxBottom(50);
+
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Choice: ";
+    resetColor();
+    int choice;
+    cin >> choice;
+    cin.ignore();
+
+    if (choice == 1) {
+        char examId[20];
+        setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID: "; resetColor();
+        cin.getline(examId, 20);
+        int examIdx = findExam(examId);
+        if (examIdx == -1 || exams[examIdx].teacherName != currentUserSym) {
+            drawBoxTop();
+            drawBoxLine("[!] Exam not found!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        {
+            TableGuard guard(0, TABLE_EXAMS);
+            exams[examIdx].isActive = false;
+        }
+        archiveInactiveRecords();
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("EXAM ARCHIVED", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxLine("Submissions and keys moved to archive", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+    } else if (choice == 2) {
+        char classId[20];
+        setColor(COLOR_INFO); cout << "\n                                                    Enter Class ID: "; resetColor();
+        cin.getline(classId, 20);
+        int classIdx = findClass(classId);
+        if (classIdx == -1 || classes[classIdx].teacherName != currentUserSym) {
+            drawBoxTop();
+            drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        {
+            TableGuard guard(0, TABLE_CLASSES);
+            classes[classIdx].isActive = false;
+        }
+        archiveInactiveRecords();
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("CLASS ARCHIVED", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxLine("Its exams, submissions and keys were archived", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+    } else if (choice == 3) {
+        viewArchivedExams();
+    } else if (choice == 4) {
+        char examId[20];
+        setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID: "; resetColor();
+        cin.getline(examId, 20);
+        int examIdx = findExam(examId);
+        if (examIdx == -1 || exams[examIdx].teacherName != currentUserSym) {
+            drawBoxTop();
+            drawBoxLine("[!] Exam not found!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        if (!confirmDelete()) return;
+        {
+            TableGuard guard(0, TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS | TABLE_KEYDIST);
+            dropExam(examIdx);
+            rebuildIndexes();
+            persistAsync(SAVE_CLASSES | SAVE_SHARDS);
+        }
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("EXAM DELETED", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxLine("Its submissions and keys were deleted", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+    } else if (choice == 5) {
+        char classId[20];
+        setColor(COLOR_INFO); cout << "\n                                                    Enter Class ID: "; resetColor();
+        cin.getline(classId, 20);
+        int classIdx = findClass(classId);
+        if (classIdx == -1 || classes[classIdx].teacherName != currentUserSym) {
+            drawBoxTop();
+            drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        if (!confirmDelete()) return;
+        {
+            TableGuard guard(0, TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS | TABLE_KEYDIST);
+            dropClass(classIdx);
+            rebuildIndexes();
+            persistAsync(SAVE_CLASSES | SAVE_SHARDS);
+        }
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("CLASS DELETED", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxLine("Its exams, submissions and keys were deleted", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+    }
+}
+
+//  COMPACTION
+// Deleted rows sit on their table's free list until new records reuse them.
+// When a quarter of a table is dead, compactTables() slides the live rows
+// down, releases the emptied chunks and rewrites the global files without
+// their tombstones. It runs from the main menu, where no screen holds a row.
+template <typename T>
+int compactRows(ChunkedTable<T>& table, const vector<unsigned char>& dead, int count) {
+    int live = 0;
+    for (int i = 0; i < count; i++) {
+        if (i < (int)dead.size() && dead[i]) continue;
+        if (live != i) table[live] = table[i];
+        live++;
+    }
+    int keepChunks = (live + TABLE_CHUNK - 1) / TABLE_CHUNK;
+    for (int i = live; i < count && i < keepChunks * TABLE_CHUNK; i++) table[i] = T();
+    while ((int)table.chunks.size() > keepChunks) {
+        delete[] table.chunks.back();
+        table.chunks.pop_back();
+    }
+    clearRows(table);
+    return live;
+}
+
+template <typename T>
+bool compactTable(ChunkedTable<T>& table, int& count, bool force, int& reclaimed) {
+    int dead = (int)table.freeRows.size();
+    if (dead == 0 || (!force && dead * 4 < count)) return false;
+    count = compactRows(table, table.dead, count);
+    reclaimed += dead;
+    return true;
+}
+
+// Returns the number of dead rows reclaimed.
+int compactTables(bool force) {
+    TableGuard guard(0, TABLE_ALL);
+    int reclaimed = 0;
+    bool classesMoved = compactTable(classes, classCount, force, reclaimed);
+    vector<unsigned char> examDead = exams.dead;
+    int examRows = examCount;
+    if (compactTable(exams, examCount, force, reclaimed)) compactRows(examPayloads, examDead, examRows);
+    vector<unsigned char> assignmentDead = assignments.dead;
+    int assignmentRows = assignmentCount;
+    if (compactTable(assignments, assignmentCount, force, reclaimed)) compactRows(assignmentPayloads, assignmentDead, assignmentRows);
+    compactTable(keyDist, keyDistCount, force, reclaimed);
+    bool messagesMoved = compactTable(messagesList, messageCount, force, reclaimed);
+    if (reclaimed == 0) return 0;
+
+    rebuildIndexes();
+    if (messagesMoved) rebuildMailboxes();
+    persistAsync((classesMoved ? SAVE_CLASSES : 0) | (messagesMoved ? SAVE_MESSAGES : 0));
+    return reclaimed;
+}
+
+template <typename T>
+void drawTableStats(const char* name, const ChunkedTable<T>& table, int count, size_t rowBytes, int colWidths[], int totalWidth) {
+    int dead = (int)table.freeRows.size();
+    char liveStr[15], deadStr[15], liveBytes[20], deadBytes[20];
+    sprintf(liveStr, "%d", count - dead);
+    sprintf(deadStr, "%d", dead);
+    sprintf(liveBytes, "%.1f", (count - dead) * rowBytes / 1024.0);
+    sprintf(deadBytes, "%.1f", dead * rowBytes / 1024.0);
+    const char* row[] = {name, liveStr, deadStr, liveBytes, deadBytes};
+    drawTableRow(row, 5, colWidths, totalWidth);
+}
+
+void drawBloomStats(const char* name, const BloomFilter& filter, int colWidths[], int totalWidth) {
+    char keys[15], probes[20], skipped[20], falsePos[20], rate[15];
+    sprintf(keys, "%d", filter.items);
+    sprintf(probes, "%lld", filter.probes.load());
+    sprintf(skipped, "%lld", filter.probes - filter.maybes);
+    sprintf(falsePos, "%lld", filter.falsePositives.load());
+    sprintf(rate, "%.2f%%", bloomFalsePositiveRate(filter) * 100);
+    const char* row[] = {name, keys, probes, skipped, falsePos, rate};
+    drawTableRow(row, 6, colWidths, totalWidth);
+}
+
+void viewSystemStats() {
+    clearScreen();
+    displayMainBanner();
+    displayHeader("SYSTEM STATISTICS");
+
+    const char* headers[] = {"Table", "Live", "Dead", "Live KB", "Dead KB"};
+    int colWidths[] = {16, 8, 8, 10, 10};
+    int totalWidth = 58;
+    cout << endl;
+    {
+        TableGuard guard(TABLE_ALL, 0);
+        drawTableHeader(headers, 5, colWidths, totalWidth);
+        drawTableStats("Users", users, userCount, sizeof(User), colWidths, totalWidth);
+        drawTableStats("Classes", classes, classCount, sizeof(Classroom), colWidths, totalWidth);
+        drawTableStats("Exams", exams, examCount, sizeof(Exam) + sizeof(ExamPayload), colWidths, totalWidth);
+        drawTableStats("Submissions", assignments, assignmentCount, sizeof(Assignment) + sizeof(AssignmentPayload), colWidths, totalWidth);
+        drawTableStats("Key dists", keyDist, keyDistCount, sizeof(KeyDistribution), colWidths, totalWidth);
+        drawTableStats("Messages", messagesList, messageCount, sizeof(Message), colWidths, totalWidth);
+        drawTableStats("Requests", requests, requestCount, sizeof(AccessRequest), colWidths, totalWidth);
+        drawTableBottom(5, colWidths, totalWidth);
+    }
+
+    // "Skipped" lookups were answered by the filter alone.
+    const char* bloomHeaders[] = {"Filter", "Keys", "Lookups", "Skipped", "False +", "FP rate"};
+    int bloomWidths[] = {12, 7, 9, 9, 9, 9};
+    int bloomWidth = 62;
+    cout << endl;
+    drawTableHeader(bloomHeaders, 6, bloomWidths, bloomWidth);
+    drawBloomStats("Usernames", userBloom, bloomWidths, bloomWidth);
+    drawBloomStats("Join codes", classCodeBloom, bloomWidths, bloomWidth);
+    drawTableBottom(6, bloomWidths, bloomWidth);
+
+    // A wait is an acquire that found the lock held in a conflicting mode.
+    const char* lockHeaders[] = {"Lock", "Acquires", "Waits", "Wait %"};
+    int lockWidths[] = {16, 12, 10, 9};
+    int lockWidth = 52;
+    cout << endl;
+    drawTableHeader(lockHeaders, 4, lockWidths, lockWidth);
+    for (int t = 0; t < TABLE_LOCK_COUNT; t++) {
+        long long acquires = lockAcquires[t], waits = lockWaits[t];
+        char acquireStr[20], waitStr[20], rate[15];
+        sprintf(acquireStr, "%lld", acquires);
+        sprintf(waitStr, "%lld", waits);
+        sprintf(rate, "%.2f%%", acquires > 0 ? 100.0 * waits / acquires : 0.0);
+        const char* row[] = {TABLE_LOCK_NAMES[t], acquireStr, waitStr, rate};
+        drawTableRow(row, 4, lockWidths, lockWidth);
+    }
+    drawTableBottom(4, lockWidths, lockWidth);
+
+    // "Stolen" tasks were taken from another worker's deque; "Helper" tasks
+    // were run by threads waiting on their own batch.
+    const char* workerHeaders[] = {"Worker", "Tasks run", "Stolen", "Queued"};
+    int workerWidths[] = {16, 12, 10, 9};
+    int workerWidth = 52;
+    cout << endl;
+    drawTableHeader(workerHeaders, 4, workerWidths, workerWidth);
+    for (int w = 0; w <= workerCount; w++) {
+        char name[20], runStr[20], stolenStr[20], queuedStr[20];
+        if (w < workerCount) {
+            mutexLock(workers[w].lock);
+            int queued = 0;
+            for (int p = 0; p < TASK_PRIORITIES; p++) queued += (int)workers[w].tasks[p].size();
+            mutexUnlock(workers[w].lock);
+            sprintf(name, "Worker %d", w + 1);
+            sprintf(runStr, "%lld", workers[w].executed.load());
+            sprintf(stolenStr, "%lld", workers[w].stolen.load());
+            sprintf(queuedStr, "%d", queued);
+        } else {
+            sprintf(name, "Helper");
+            sprintf(runStr, "%lld", helperTasks.load());
+            sprintf(stolenStr, "-");
+            sprintf(queuedStr, "max %d", maxQueuedTasks.load());
+        }
+        const char* row[] = {name, runStr, stolenStr, queuedStr};
+        drawTableRow(row, 4, workerWidths, workerWidth);
+    }
+    drawTableBottom(4, workerWidths, workerWidth);
+
+    // Saves requested by mutations versus write passes that served them.
+    long long requested = persistRequests, passes = savePasses;
+    char persistLine[100];
+    sprintf(persistLine, "Persistence: %lld saves requested, %lld write passes (%.1f per pass)",
+            requested, passes, passes > 0 ? (double)requested / passes : 0.0);
+    cout << endl << "  " << persistLine << endl;
+
+    mutexLock(attemptsLock);
+    int openCount = (int)openAttempts.size(), timers = attemptWheel.active;
+    mutexUnlock(attemptsLock);
+    char attemptLine[120];
+    sprintf(attemptLine, "Timed attempts: %d open (%d timers), %lld started, %lld submitted at the deadline",
+            openCount, timers, attemptsStarted.load(), attemptsAutoSubmitted.load());
+    cout << "  " << attemptLine << endl;
+
+    long long committed = submissionsCommitted, batches = submitBatches;
+    char ingestLine[160];
+    sprintf(ingestLine, "Submissions: %lld in %lld commits (%.1f per commit), peak %lld/s, commit p50 %lld ms, p99 %lld ms",
+            committed, batches, batches > 0 ? (double)committed / batches : 0.0, peakSubmitRate.load(),
+            latencyPercentile(submitLatency, 50), latencyPercentile(submitLatency, 99));
+    cout << "  " << ingestLine << endl;
+
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    1. Compact now   0. Back: ";
+    resetColor();
+    int choice;
+    if (!(cin >> choice)) {
+        cin.clear();
+        choice = 0;
+    }
+    cin.ignore(1000, '\n');
+    if (choice != 1) return;
+
+    char buffer[100];
+    sprintf(buffer, "Reclaimed %d dead rows", compactTables(true));
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("COMPACTION COMPLETE", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    drawBoxBottom();
+    pauseScreen();
+}
+
+// NEW FEATURE: VIEW RSA KEY INFO 
+void viewMyKeyInfo() {
+    clearScreen();
+    displayRSABanner();
+    displayHeader("MY RSA KEY INFORMATION");
+    
+    int userIdx = findUser(currentUser);
+    if (userIdx == -1) {
+        drawBoxTop();
+        drawBoxLine("Error: User not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    RSAKeys& keys = users[userIdx].keys;
+    
+    drawBoxTop();
+    drawBoxLine("=== YOUR RSA KEYS ===", BOX_WIDTH, COLOR_HEADER);
+    drawBoxMiddle();
+    
+    char buffer[100];
+    
+    drawBoxLineLeft("PUBLIC KEY (Share this):", BOX_WIDTH, COLOR_SUCCESS);
+    sprintf(buffer, "  e = %lld", keys.e);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "  n = %lld", keys.n);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    
+    drawBoxMiddle();
+    
+    drawBoxLineLeft("PRIVATE KEY (Keep secret!):", BOX_WIDTH, COLOR_ERROR);
+    sprintf(buffer, "  d = %lld", keys.d);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    
+    drawBoxMiddle();
+    
+    drawBoxLineLeft("KEY GENERATION PARAMETERS:", BOX_WIDTH, COLOR_HEADER);
+    sprintf(buffer, "  Prime p = %lld", keys.p);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    sprintf(buffer, "  Prime q = %lld", keys.q);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    sprintf(buffer, "  phi(n) = %lld", keys.phi);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    sprintf(buffer, "  n = p * q = %lld", keys.n);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    
+    drawBoxMiddle();
+    
+    // Verify key correctness
+    bool valid = (keys.n == keys.p * keys.q) && 
+                 (keys.phi == (keys.p - 1) * (keys.q - 1)) &&
+                 (gcd(keys.e, keys.phi) == 1) &&
+                 ((keys.e * keys.d) % keys.phi == 1);
+    
+    if (valid) {
+        drawBoxLine("KEY VERIFICATION: VALID", BOX_WIDTH, COLOR_SUCCESS);
+    } else {
+        drawBoxLine("KEY VERIFICATION: INVALID", BOX_WIDTH, COLOR_ERROR);
+    }
+    
+    drawBoxBottom();
+    
+    cout << endl;
+    drawBoxTop(50);
+    drawBoxLine("RSA FORMULA REFERENCE", 50, COLOR_HEADER);
+    drawBoxMiddle(50);
+    drawBoxLineLeft("Encrypt: C = M^e mod n", 50, COLOR_INFO);
+    drawBoxLineLeft("Decrypt: M = C^d mod n", 50, COLOR_INFO);
+    drawBoxLineLeft("Sign:    S = H^d mod n", 50, COLOR_INFO);
+    drawBoxLineLeft("Verify:  H = S^e mod n", 50, COLOR_INFO);
+    drawBoxBottom(50);
+    
+    pauseScreen();
+}
+
+//NEW FEATURE: RSA ENCRYPTION DEMO 
 void rsaEncryptionDemo() {
     clearScreen();
-    displayRSABanner();
-    displayHeader("RSA ENCRYPTION DEMO");
+    displayRSABanner();
+    displayHeader("RSA ENCRYPTION DEMO");
+    
+    int userIdx = findUser(currentUser);
+    RSAKeys& keys = users[userIdx].keys;
+    
+    drawBoxTop();
+    drawBoxLine("Interactive RSA Demonstration", BOX_WIDTH, COLOR_HEADER);
+    drawBoxBottom();
+    
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter a message to encrypt (max 50 chars): ";
+    resetColor();
+    
+    char message[51];
+    cin.getline(message, 51);
+    
+    if (strlen(message) == 0) {
+        drawBoxTop();
+        drawBoxLine("No message entered!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    cout << endl;
+    displaySectionHeader("STEP 1: ORIGINAL MESSAGE");
+    drawBoxTop();
+    drawBoxLine(message, BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxBottom();
+    
+    // Show character-by-character encryption
+    displaySectionHeader("STEP 2: CHARACTER ENCRYPTION");
+    
+    const char* headers[] = {"Char", "ASCII", "Encrypted"};
+    int colWidths[] = {8, 12, 20};
+    int totalWidth = 44;
+    
+    drawTableHeader(headers, 3, colWidths, totalWidth);
+    
+    char encrypted[2000];
+    encrypted[0] = '\0';
+    char temp[20];
+    
+    int len = strlen(message);
+    for (int i = 0; i < len && i < 10; i++) {  // Show first 10 chars
+        long long m = (long long)(unsigned char)message[i];
+        long long c = modPow(m, keys.e, keys.n);
+        
+        char charStr[10], asciiStr[15], encStr[25];
+        sprintf(charStr, "%c", message[i]);
+        sprintf(asciiStr, "%lld", m);
+        sprintf(encStr, "%lld", c);
+        
+        const char* row[] = {charStr, asciiStr, encStr};
+        drawTableRow(row, 3, colWidths, totalWidth);
+        
+        sprintf(temp, "%lld ", c);
+        strcat(encrypted, temp);
+    }
+    
+    if (len > 10) {
+        const char* ellipsis[] = {"...", "...", "..."};
+        drawTableRow(ellipsis, 3, colWidths, totalWidth);
+    }
+    
+    drawTableBottom(3, colWidths, totalWidth);
+    
+    // Full encryption
+    encryptMessage(message, encrypted, keys.e, keys.n);
+    
+    displaySectionHeader("STEP 3: ENCRYPTED MESSAGE");
+    cout << endl;
+    setColor(COLOR_BOX);
+    centerText("+----------------------------------------------------------+");
+    resetColor();
+    setColor(COLOR_ERROR);
+    // Print encrypted in chunks
+    int eLen = strlen(encrypted);
+    for (int i = 0; i < eLen; i += 50) {
+        char chunk[51];
+        strncpy(chunk, encrypted + i, 50);
+        chunk[50] = '\0';
+        centerText(chunk);
+    }
+    resetColor();
+    setColor(COLOR_BOX);
+    centerText("+----------------------------------------------------------+");
+    resetColor();
+    
+    // Decryption
+    displaySectionHeader("STEP 4: DECRYPTION");
+    char decrypted[2000];
+    decryptMessage(encrypted, decrypted, keys.d, keys.n);
+    
+    drawBoxTop();
+    drawBoxLine("Decrypted Message:", BOX_WIDTH, COLOR_HEADER);
+    drawBoxLine(decrypted, BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxBottom();
+    
+    // Verify
+    cout << endl;
+    if (strcmp(message, decrypted) == 0) {
+        drawBoxTop(40);
+        drawBoxLine("VERIFICATION: SUCCESS!", 40, COLOR_SUCCESS);
+        drawBoxLine("Original = Decrypted", 40, COLOR_SUCCESS);
+        drawBoxBottom(40);
+    } else {
+        drawBoxTop(40);
+        drawBoxLine("VERIFICATION: FAILED!", 40, COLOR_ERROR);
+        drawBoxBottom(40);
+    }
+    
+    pauseScreen();
+}
+
+//  NEW FEATURE: DIGITAL SIGNATURE DEMO
+void digitalSignatureDemo() {
+    clearScreen();
+    displayRSABanner();
+    displayHeader("DIGITAL SIGNATURE DEMO");
+    
+    int userIdx = findUser(currentUser);
+    RSAKeys& keys = users[userIdx].keys;
+    
+    drawBoxTop();
+    drawBoxLine("Digital Signature Demonstration", BOX_WIDTH, COLOR_HEADER);
+    drawBoxMiddle();
+    drawBoxLineLeft("Sign with PRIVATE key (d)", BOX_WIDTH, COLOR_INFO);
+    drawBoxLineLeft("Verify with PUBLIC key (e)", BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+    
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter a document to sign: ";
+    resetColor();
+    
+    char document[200];
+    cin.getline(document, 200);
+    
+    if (strlen(document) == 0) {
+        strcpy(document, "This is a test document");
+    }
+    
+    displaySectionHeader("STEP 1: ORIGINAL DOCUMENT");
+    drawBoxTop();
+    drawBoxLine(document, BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxBottom();
+    
+    // Create hash
+    displaySectionHeader("STEP 2: CALCULATE HASH");
+    long long hash = 0;
+    int len = strlen(document);
+    for (int i = 0; i < len; i++) {
+        hash = (hash * 31 + document[i]) % 1000000007;
+    }
+    
+    char buffer[100];
+    sprintf(buffer, "Hash(document) = %lld", hash);
+    drawBoxTop();
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+    
+    // Sign
+    displaySectionHeader("STEP 3: CREATE SIGNATURE");
+    long long signature = createSignature(document, keys.d, keys.n);
+    
+    sprintf(buffer, "Signature = Hash^d mod n");
+    drawBoxTop();
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_HEADER);
+    sprintf(buffer, "Signature = %lld", signature);
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxBottom();
+    
+    // Verify
+    displaySectionHeader("STEP 4: VERIFY SIGNATURE");
+    bool verified = verifySignature(document, signature, keys.e, keys.n);
+    
+    drawBoxTop();
+    drawBoxLine("Verification: Signature^e mod n = Hash?", BOX_WIDTH, COLOR_HEADER);
+    if (verified) {
+        drawBoxLine("SIGNATURE VALID!", BOX_WIDTH, COLOR_SUCCESS);
+    } else {
+        drawBoxLine("SIGNATURE INVALID!", BOX_WIDTH, COLOR_ERROR);
+    }
+    drawBoxBottom();
+    
+    // Tamper test
+    cout << endl;
+    drawBoxTop(50);
+    drawBoxLine("TAMPER TEST", 50, COLOR_INFO);
+    drawBoxMiddle(50);
+    drawBoxLineLeft("Modified document:", 50, COLOR_DEFAULT);
+    
+    char tampered[200];
+    strcpy(tampered, document);
+    if (strlen(tampered) > 0) tampered[0] = tampered[0] + 1;
+    
+    bool tamperedVerify = verifySignature(tampered, signature, keys.e, keys.n);
+    
+    if (!tamperedVerify) {
+        drawBoxLine("Tamper detected correctly!", 50, COLOR_SUCCESS);
+    } else {
+        drawBoxLine("Warning: Tamper not detected", 50, COLOR_ERROR);
+    }
+    drawBoxBottom(50);
+    
+    pauseScreen();
+}
+
+// USER REGISTRATION & LOGIN 
+// Adds a user row with keys already generated. Caller holds TABLE_USERS
+// for writing and requests the save.
+int insertUser(const char* username, const char* passwordHash, const char* role, const RSAKeys& keys) {
+    int newRow = allocRow(users, userCount);
+    users[newRow].username = intern(username);
+    strncpy(users[newRow].password, passwordHash, 49);
+    users[newRow].password[49] = '\0';
+    strncpy(users[newRow].role, role, 19); 
+    users[newRow].role[19] = '\0';
+    users[newRow].keys = keys;
+    users[newRow].isActive = true;
+    indexSet(userIndex, users[newRow].username, newRow);
+    if (!bloomAdd(userBloom, username)) rebuildUserBloom();
+    return newRow;
+}
+
+int addUser(const char* username, const char* password, const char* role) {
+    RSAKeys keys;
+    char passwordHash[50];
+    generateRSAKeys(keys);
+    sprintf(passwordHash, "%lld", hashPassword(password));
+    TableGuard guard(0, TABLE_USERS);
+    int newRow = insertUser(username, passwordHash, role, keys);
+    persistAsync(SAVE_USERS);
+    return newRow;
+}
+
+void  registerUser() {
+    clearScreen();
+    displayMainBanner();
+    displayHeader("REGISTER NEW USER");
+    
+    char username[50], role[20], password[50];
+    
+    drawBoxTop();
+    drawBoxLine("Enter Registration Details", BOX_WIDTH, COLOR_HEADER);
+    drawBoxBottom();
+    
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Username: ";
+    resetColor();
+    cin.getline(username, 50);
+    
+    if (findUser(username) != -1) {
+        drawBoxTop();
+        drawBoxLine("[!] Username already exists!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    setColor(COLOR_INFO);
+    cout << "                                                    Role (teacher/student): ";
+    resetColor();
+    cin.getline(role, 20);
+    
+    int len = strlen(role);
+    for (int i = 0; i < len; i++) {
+        if (role[i] >= 'A' && role[i] <= 'Z') role[i] += 32;
+    }
+    
+    if (strcmp(role, "teacher") != 0 && strcmp(role, "student") != 0) {
+        drawBoxTop();
+        drawBoxLine("[!] Invalid role!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("Must be 'teacher' or 'student'", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    setColor(COLOR_INFO);
+    cout << "                                                    Password: ";
+    resetColor();
+    cin.getline(password, 50);
+    
+    if (strlen(password) < 4) {
+        drawBoxTop();
+        drawBoxLine("[!] Password too short!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("Minimum 4 characters required", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    int newRow = addUser(username, password, role);
+    
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("REGISTRATION SUCCESSFUL!", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
+    
+    char buffer[100];
+    sprintf(buffer, "Username: %s", username);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Role: %s", role);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    
+    drawBoxMiddle();
+    drawBoxLine("RSA KEYS GENERATED", BOX_WIDTH, COLOR_HEADER);
+    drawBoxMiddle();
+    
+    sprintf(buffer, "Public Key (e): %lld", users[newRow].keys.e);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
+    sprintf(buffer, "Public Key (n): %lld", users[newRow].keys.n);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
+    sprintf(buffer, "Private Key (d): %lld [KEEP SECRET]", users[newRow].keys.d);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_ERROR);
+    
+    drawBoxBottom();
+    pauseScreen();
+}
+
+enum LoginResult { LOGIN_OK, LOGIN_NO_USER, LOGIN_BAD_PASSWORD, LOGIN_WRONG_ROLE, LOGIN_INACTIVE };
+
+// Checks credentials for the console and for server sessions. role must be
+// lower case; userIdx is set whenever the user exists.
+LoginResult checkLogin(const char* username, const char* password, const char* role, int& userIdx) {
+    TableGuard guard(TABLE_USERS, 0);
+    userIdx = findUser(username);
+    if (userIdx == -1) return LOGIN_NO_USER;
+    char hashedPass[50];
+    sprintf(hashedPass, "%lld", hashPassword(password));
+    if (strcmp(users[userIdx].password, hashedPass) != 0) return LOGIN_BAD_PASSWORD;
+    if (strcmp(users[userIdx].role, role) != 0) return LOGIN_WRONG_ROLE;
+    if (!users[userIdx].isActive) return LOGIN_INACTIVE;
+    return LOGIN_OK;
+}
+
+bool login() {
+    clearScreen();
+    displayMainBanner();
+    displayHeader("USER LOGIN");
+    
+    char username[50], password[50], attemptedRole[20];
+    
+    drawBoxTop();
+    drawBoxLine("Enter Login Credentials", BOX_WIDTH, COLOR_HEADER);
+    drawBoxBottom();
+    
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Username: ";
+    resetColor();
+    cin.getline(username, 50);
+    
+    setColor(COLOR_INFO);
+    cout << "                                                    Password: ";
+    resetColor();
+    cin.getline(password, 50);
+    
+    setColor(COLOR_INFO);
+    cout << "                                                    Login as (teacher/student): ";
+    resetColor();
+    cin.getline(attemptedRole, 20);
+    
+    int len = strlen(attemptedRole);
+    for (int i = 0; i < len; i++) {
+        if (attemptedRole[i] >= 'A' && attemptedRole[i] <= 'Z') attemptedRole[i] += 32;
+    }
+    
+    int userIdx;
+    LoginResult result = checkLogin(username, password, attemptedRole, userIdx);
+    if (result == LOGIN_NO_USER) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("[!] User not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return false;
+    }
+    
+    if (result == LOGIN_BAD_PASSWORD) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("[!] Incorrect password!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return false;
+    }
+    
+    if (result == LOGIN_WRONG_ROLE) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("ACCESS DENIED", BOX_WIDTH, COLOR_ERROR);
+        drawBoxMiddle();
+        char buffer[60];
+        sprintf(buffer, "You are registered as: %s", users[userIdx].role);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+        sprintf(buffer, "Cannot login to: %s portal", attemptedRole);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+        drawBoxBottom();
+        pauseScreen();
+        return false;
+    }
+    
+    if (result == LOGIN_INACTIVE) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("[!] Account is deactivated!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return false;
+    }
+    
+    strncpy(currentUser, username, 49); 
+    currentUser[49] = '\0';
+    currentUserSym = users[userIdx].username;
+    strncpy(currentRole, users[userIdx].role, 19); 
+    currentRole[19] = '\0';
+    
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("LOGIN SUCCESSFUL!", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
+    
+    char buffer[60];
+    sprintf(buffer, "Welcome back, %s!", username);
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Role: %s", currentRole);
+    drawBoxLine(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    
+    drawBoxBottom();
+    
+    // Notifications
+    if (strcmp(currentRole, "teacher") == 0) {
+        int pending = countPendingRequests();
+        if (pending > 0) {
+            cout << endl;
+            drawBoxTop(50);
+            char notif[60];
+            sprintf(notif, "[!] %d pending access request(s)", pending);
+            drawBoxLine(notif, 50, COLOR_INFO);
+            drawBoxBottom(50);
+        }
+    } else {
+        int unreadKeys = countUnreadKeys();
+        if (unreadKeys > 0) {
+            cout << endl;
+            drawBoxTop(50);
+            char notif[60];
+            sprintf(notif, "[!] %d new exam key(s)", unreadKeys);
+            drawBoxLine(notif, 50, COLOR_INFO);
+            drawBoxBottom(50);
+        }
+    }
+    
+    pauseScreen();
+    return true;
+}
+
+// CLASS MANAGEMENT 
+int addClass(const char* className, Symbol teacher) {
+    TableGuard guard(0, TABLE_CLASSES);
+    int newRow = allocRow(classes, classCount);
+    classes[newRow].classId = generateId("CLS");
+    strncpy(classes[newRow].className, className, 99); 
+    classes[newRow].className[99] = '\0';
+    generateClassCode(classes[newRow].classCode);
+    classes[newRow].teacherName = teacher;
+    classes[newRow].isActive = true;
+    indexSet(classIndex, classes[newRow].classId, newRow);
+    indexTeacherClass(newRow);
+    indexInsert(classCodeIndex, newRow);
+    if (!bloomAdd(classCodeBloom, classes[newRow].classCode)) rebuildClassCodeBloom();
+    persistAsync(SAVE_CLASSES);
+    return newRow;
+}
+
+void createClass() {
+    clearScreen();
+    displayClassBanner();
+    displayHeader("CREATE NEW CLASS");
+    
+    char className[100];
+    
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter Class Name: ";
+    resetColor();
+    cin.getline(className, 100);
+    
+    if (strlen(className) == 0) {
+        drawBoxTop();
+        drawBoxLine("[!] Class name cannot be empty!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    int newRow = addClass(className, currentUserSym);
+    
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("CLASS CREATED SUCCESSFULLY!", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
+    
+    char buffer[60];
+    sprintf(buffer, "Class ID: %s", symbolName(classes[newRow].classId));
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Class Name: %s", className);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    
+    drawBoxMiddle();
+    drawBoxLine("JOIN CODE", BOX_WIDTH, COLOR_HEADER);
+    drawBoxMiddle();
+    
+    // Large display of join code
+    char codeDisplay[20];
+    sprintf(codeDisplay, "[ %s ]", classes[newRow].classCode);
+    drawBoxLine(codeDisplay, BOX_WIDTH, COLOR_SUCCESS);
+    
+    drawBoxMiddle();
+    drawBoxLine("Share this code with students!", BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+    pauseScreen();
+}
+
+void viewMyClasses() {
+    clearScreen();
+    displayClassBanner();
+    displayHeader("MY CLASSES");
     
-    int userIdx = findUser(currentUser);
-    RSAKeys& keys = users[userIdx].keys;
+    bool found = false;
+    
+    const vector<int>& myClasses = viewOfTeacher(currentUserSym).classes;
+    for (int r = 0; r < (int)myClasses.size(); r++) {
+        int i = myClasses[r];
+        if (classes[i].isActive) {
+            found = true;
+            cout << endl;
+            drawBoxTop();
+            
+            char buffer[60];
+            drawBoxLine(classes[i].className, BOX_WIDTH, COLOR_HEADER);
+            drawBoxMiddle();
+            
+            sprintf(buffer, "ID: %s", symbolName(classes[i].classId));
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+            sprintf(buffer, "Join Code: %s", classes[i].classCode);
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
+            sprintf(buffer, "Students: %d", (int)classes[i].enrolledStudents.size());
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+            sprintf(buffer, "Exams: %d", (int)classes[i].assignedExams.size());
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+            
+            if (!classes[i].enrolledStudents.empty()) {
+                drawBoxMiddle();
+                drawBoxLine("Enrolled Students:", BOX_WIDTH, COLOR_INFO);
+                for (int j = 0; j < (int)classes[i].enrolledStudents.size(); j++) {
+                    sprintf(buffer, "  - %s", symbolName(classes[i].enrolledStudents[j]));
+                    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+                }
+            }
+            
+            drawBoxBottom();
+        }
+    }
+    
+    if (!found) {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("No classes created yet", BOX_WIDTH, COLOR_INFO);
+        drawBoxLine("Use 'Create Class' to get started!", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+    }
+    
+    pauseScreen();
+}
+
+enum JoinResult { JOIN_OK, JOIN_ALREADY_ENROLLED, JOIN_INVALID_CODE };
+
+JoinResult joinClassByCode(Symbol student, const char* code, int& classIdx) {
+    TableGuard guard(0, TABLE_CLASSES);
+    classIdx = findClassByCode(code);
+    if (classIdx == -1 || !classes[classIdx].isActive) return JOIN_INVALID_CODE;
+    if (rosterContains(classes[classIdx].enrolledStudents, student)) return JOIN_ALREADY_ENROLLED;
+    rosterInsert(classes[classIdx].enrolledStudents, student);
+    indexEnrollment(student, classes[classIdx].classId);
+    persistAsync(SAVE_CLASSES);
+    return JOIN_OK;
+}
+
+void joinClass() {
+    clearScreen();
+    displayClassBanner();
+    displayHeader("JOIN A CLASS");
+    
+    drawBoxTop();
+    drawBoxLine("Enter 6-digit class code", BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+    
+    char code[10];
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Class Code: ";
+    resetColor();
+    cin.getline(code, 10);
+    
+    int i;
+    JoinResult result = joinClassByCode(currentUserSym, code, i);
+    if (result != JOIN_INVALID_CODE) {
+        if (result == JOIN_ALREADY_ENROLLED) {
+            cout << endl;
+            drawBoxTop();
+            drawBoxLine("[!] Already enrolled in this class!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("SUCCESSFULLY JOINED CLASS!", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxMiddle();
+        
+        char buffer[60];
+        sprintf(buffer, "Class: %s", classes[i].className);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+        sprintf(buffer, "Teacher: %s", symbolName(classes[i].teacherName));
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        
+        drawBoxMiddle();
+        drawBoxLine("You will receive exam keys from this class", BOX_WIDTH, COLOR_INFO);
+        drawBoxBottom();
+        
+        pauseScreen();
+        return;
+    }
+    
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("[!] Invalid class code!", BOX_WIDTH, COLOR_ERROR);
+    drawBoxBottom();
+    pauseScreen();
+}
+
+void viewMyEnrolledClasses() {
+    clearScreen();
+    displayClassBanner();
+    displayHeader("MY ENROLLED CLASSES");
+    
+    bool found = false;
+    
+    // Table setup
+    const char* headers[] = {"Class Name", "Teacher", "Students", "Exams"};
+    int colWidths[] = {20, 15, 10, 8};
+    int totalWidth = 57;
+    
+    bool headerPrinted = false;
+    
+    vector<int> classRows;
+    if (currentUserSym >= 0 && currentUserSym < (int)studentViews.size()) {
+        const vector<Symbol>& enrolled = studentViews[currentUserSym].classes;
+        for (int j = 0; j < (int)enrolled.size(); j++) {
+            int classIdx = findClass(enrolled[j]);
+            if (classIdx != -1) classRows.push_back(classIdx);
+        }
+    }
+    sort(classRows.begin(), classRows.end());
+    
+    for (int r = 0; r < (int)classRows.size(); r++) {
+        int i = classRows[r];
+        if (!headerPrinted) {
+            cout << endl;
+            drawTableHeader(headers, 4, colWidths, totalWidth);
+            headerPrinted = true;
+        }
+        
+        found = true;
+        char studentStr[15], examStr[10];
+        sprintf(studentStr, "%d", (int)classes[i].enrolledStudents.size());
+        sprintf(examStr, "%d", (int)classes[i].assignedExams.size());
+        
+        const char* row[] = {classes[i].className, symbolName(classes[i].teacherName), studentStr, examStr};
+        drawTableRow(row, 4, colWidths, totalWidth);
+    }
+    
+    if (found) {
+        drawTableBottom(4, colWidths, totalWidth);
+    } else {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("Not enrolled in any classes", BOX_WIDTH, COLOR_INFO);
+        drawBoxLine("Use 'Join Class' to enroll!", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+    }
+    
+    pauseScreen();
+}
+
+//  ROSTER IMPORT
+// A roster CSV has one "username,password" line per student; a first line
+// starting with "username" is a header. New accounts have their keys
+// generated on the executor, outside any lock. Then all of them are added
+// and enrolled under one write lock and saved with one write each of
+// users.txt and classes.txt. Students who already have an account are only
+// enrolled.
+const int KEYGEN_GRAIN = 64;        // accounts per key generation task
+const int ROSTER_ERRORS_SHOWN = 5;
+
+struct RosterEntry {
+    char username[50];
+    char password[50];
+    char passwordHash[50];   // set with the keys
+    RSAKeys keys;
+};
+
+struct RosterReport {
+    int created;
+    int enrolled;            // new to the class, created ones included
+    int alreadyEnrolled;
+    int rejected;
+    vector<string> errors;   // the first few rejected lines
+    long long keygenMs;
+    long long totalMs;
+};
+
+void keygenRange(void* arg, int begin, int end) {
+    RosterEntry* entries = (RosterEntry*)arg;
+    for (int i = begin; i < end; i++) {
+        generateRSAKeys(entries[i].keys);
+        sprintf(entries[i].passwordHash, "%lld", hashPassword(entries[i].password));
+    }
+}
+
+void rejectRosterLine(RosterReport& report, int lineNo, const char* reason) {
+    report.rejected++;
+    if ((int)report.errors.size() < ROSTER_ERRORS_SHOWN) {
+        report.errors.push_back("Line " + to_string(lineNo) + ": " + reason);
+    }
+}
+
+string_view trimField(string_view field) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) field.remove_prefix(1);
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t')) field.remove_suffix(1);
+    return field;
+}
+
+// Imports the roster text into the class. False if the class is gone.
+bool importRoster(Symbol classId, string_view text, RosterReport& report) {
+    report = RosterReport();
+    long long started = monotonicMs();
+
+    // 1. Parse and check each line, the same way registerUser() checks input.
+    vector<RosterEntry> fresh;
+    vector<Symbol> existing;
+    unordered_map<string_view, int> seen;
+    CsvCursor file = csvCursor(text);
+    string_view line;
+    int lineNo = 0;
+    {
+        TableGuard guard(TABLE_USERS, 0);
+        while (csvNextLine(file, line)) {
+            lineNo++;
+            string_view cols[2];
+            if (csvSplit(line, cols, 2) < 2) {
+                if (!trimField(line).empty()) rejectRosterLine(report, lineNo, "expected username,password");
+                continue;
+            }
+            string_view name = trimField(cols[0]), password = trimField(cols[1]);
+            if (lineNo == 1 && name == "username") continue;
+            if (name.empty() || name.size() > 49) {
+                rejectRosterLine(report, lineNo, "username must be 1-49 characters");
+                continue;
+            }
+            if (password.size() < 4 || password.size() > 49) {
+                rejectRosterLine(report, lineNo, "password must be 4-49 characters");
+                continue;
+            }
+            if (!seen.insert(make_pair(name, lineNo)).second) {
+                rejectRosterLine(report, lineNo, "username repeated in the file");
+                continue;
+            }
+            RosterEntry entry;
+            csvCopy(entry.username, sizeof(entry.username), name);
+            csvCopy(entry.password, sizeof(entry.password), password);
+            int userIdx = findUser(entry.username);
+            if (userIdx == -1) {
+                fresh.push_back(entry);
+            } else if (strcmp(users[userIdx].role, "student") != 0) {
+                rejectRosterLine(report, lineNo, "existing account is not a student");
+            } else {
+                existing.push_back(users[userIdx].username);
+            }
+        }
+    }
+
+    // 2. Generate keys for the new accounts in parallel.
+    long long keygenStart = monotonicMs();
+    parallelFor(0, (int)fresh.size(), KEYGEN_GRAIN, keygenRange, fresh.data(), PRIORITY_BULK);
+    report.keygenMs = monotonicMs() - keygenStart;
+
+    // 3. Add the accounts and merge everyone into the roster in one pass.
+    {
+        TableGuard guard(0, TABLE_USERS | TABLE_CLASSES);
+        int classIdx = findClass(classId);
+        if (classIdx == -1) return false;
+        for (int i = 0; i < (int)fresh.size(); i++) {
+            int userIdx = findUser(fresh[i].username);
+            if (userIdx != -1) {   // registered meanwhile
+                existing.push_back(users[userIdx].username);
+                continue;
+            }
+            userIdx = insertUser(fresh[i].username, fresh[i].passwordHash, "student", fresh[i].keys);
+            existing.push_back(users[userIdx].username);
+            report.created++;
+        }
+        vector<Symbol>& roster = classes[classIdx].enrolledStudents;
+        vector<Symbol> joining;
+        for (int i = 0; i < (int)existing.size(); i++) {
+            if (rosterContains(roster, existing[i])) report.alreadyEnrolled++;
+            else joining.push_back(existing[i]);
+        }
+        sort(joining.begin(), joining.end());
+        for (int i = 0; i < (int)joining.size(); i++) indexEnrollment(joining[i], classId);
+        size_t before = roster.size();
+        roster.insert(roster.end(), joining.begin(), joining.end());
+        inplace_merge(roster.begin(), roster.begin() + before, roster.end());
+        report.enrolled = (int)joining.size();
+        persistAsync(SAVE_USERS | SAVE_CLASSES);
+    }
+    flushPersistence();
+    report.totalMs = monotonicMs() - started;
+    return true;
+}
+
+void importClassRoster() {
+    clearScreen();
+    displayClassBanner();
+    displayHeader("IMPORT CLASS ROSTER");
+
+    char classId[20], path[260];
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter Class ID: ";
+    resetColor();
+    cin.getline(classId, 20);
+
+    Symbol classSym;
+    {
+        TableGuard guard(TABLE_CLASSES, 0);
+        int classIdx = findClass(classId);
+        classSym = (classIdx != -1 && classes[classIdx].teacherName == currentUserSym) ? classes[classIdx].classId : NO_SYMBOL;
+    }
+    if (classSym == NO_SYMBOL) {
+        drawBoxTop();
+        drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    setColor(COLOR_INFO);
+    cout << "                                                    Roster CSV file (username,password): ";
+    resetColor();
+    cin.getline(path, 260);
+
+    string text;
+    if (!csvReadFile(path, text)) {
+        drawBoxTop();
+        drawBoxLine("[!] Could not read the roster file!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    RosterReport report;
+    if (!importRoster(classSym, text, report)) {
+        drawBoxTop();
+        drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    cout << endl;
+    drawBoxTop();
+    drawBoxLine("ROSTER IMPORTED", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
+    char buffer[100];
+    sprintf(buffer, "Accounts created: %d", report.created);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Enrolled in %s: %d", classId, report.enrolled);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Already enrolled: %d", report.alreadyEnrolled);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Rejected lines: %d", report.rejected);
+    drawBoxLineLeft(buffer, BOX_WIDTH, report.rejected > 0 ? COLOR_ERROR : COLOR_INFO);
+    sprintf(buffer, "Time: %lld ms (key generation %lld ms)", report.totalMs, report.keygenMs);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    if (!report.errors.empty()) {
+        drawBoxMiddle();
+        for (int i = 0; i < (int)report.errors.size(); i++) {
+            drawBoxLineLeft(report.errors[i].c_str(), BOX_WIDTH, COLOR_ERROR);
+        }
+        if (report.rejected > (int)report.errors.size()) drawBoxLineLeft("...", BOX_WIDTH, COLOR_ERROR);
+    }
+    drawBoxBottom();
+    pauseScreen();
+}
+
+// ============= EXAM MANAGEMENT =============
+// Release and close times are entered and shown as local "YYYY-MM-DD HH:MM".
+// A blank entry leaves the time unset.
+bool parseScheduleTime(const char* text, long long& out) {
+    out = 0;
+    if (text[0] == '\0') return true;
+    tm parts = {};
+    if (sscanf(text, "%d-%d-%d %d:%d", &parts.tm_year, &parts.tm_mon, &parts.tm_mday,
+               &parts.tm_hour, &parts.tm_min) != 5) return false;
+    parts.tm_year -= 1900;
+    parts.tm_mon -= 1;
+    parts.tm_isdst = -1;
+    time_t t = mktime(&parts);
+    if (t == (time_t)-1) return false;
+    out = (long long)t;
+    return true;
+}
+
+void formatScheduleTime(long long when, char* buffer, int size) {
+    time_t t = (time_t)when;
+    strftime(buffer, size, "%Y-%m-%d %H:%M", localtime(&t));
+}
+
+// Returns the new exam row, or -1 when teacher has no account to sign it.
+int addExam(int classIdx, const char* title, const char* content, int duration,
+            long long opensAt, long long closesAt, Symbol teacher) {
+    TableGuard guard(TABLE_USERS | TABLE_ASSIGNMENTS | TABLE_KEYDIST, TABLE_CLASSES | TABLE_EXAMS);
+    int userIdx = findUser(teacher);
+    if (userIdx == -1) return -1;
+    int newRow = allocRow(exams, examCount);
+    examPayloads.ensure(newRow) = ExamPayload();
+    exams[newRow].id = generateId("EXAM");
+    strncpy(examPayloads[newRow].title, title, 99); 
+    examPayloads[newRow].title[99] = '\0';
+    exams[newRow].teacherName = teacher;
+    exams[newRow].assignedClassId = classes[classIdx].classId;
+    strncpy(examPayloads[newRow].assignedClassName, classes[classIdx].className, 99); 
+    examPayloads[newRow].assignedClassName[99] = '\0';
+    exams[newRow].duration = duration;
+    exams[newRow].opensAt = opensAt;
+    exams[newRow].closesAt = closesAt;
+    exams[newRow].isActive = true;
+    exams[newRow].approvedStudents = SymbolSet();
+    exams[newRow].keyDistributed = false;
+    RSAKeys examKeys;
+    generateRSAKeys(examKeys); 
+
+    // Store them in the exam struct
+    examPayloads[newRow].exam_n = examKeys.n;
+    examPayloads[newRow].exam_e = examKeys.e;
+    examPayloads[newRow].exam_d = examKeys.d;
+    examPayloads[newRow].exam_p = examKeys.p;
+    examPayloads[newRow].exam_q = examKeys.q;
+   encryptMessage(content, examPayloads[newRow].encryptedContent, examPayloads[newRow].exam_e, examPayloads[newRow].exam_n);
+    
+    // Digital signature
+   long long sig = createSignature(content, users[userIdx].keys.d, users[userIdx].keys.n);
+    examPayloads[newRow].signature.signedBy = teacher;
+    examPayloads[newRow].signature.signatureHash = sig;
+    examPayloads[newRow].signature.isVerified = true;
+    
+    classes[classIdx].assignedExams.push_back(exams[newRow].id);
+    indexSet(examIndex, exams[newRow].id, newRow);
+    indexTeacherExam(newRow);
+    indexShardExam(newRow);
+    markShardDirty(symbolName(classes[classIdx].classId));
+    persistAsync(SAVE_SHARDS | SAVE_CLASSES);
+    return newRow;
+}
+
+void createExam() {
+    clearScreen();
+    displayExamBanner();
+    displayHeader("CREATE NEW EXAM");
+    
+    displaySectionHeader("YOUR CLASSES");
+    
+    bool hasClasses = false;
+    const char* headers[] = {"Class ID", "Class Name", "Students"};
+    int colWidths[] = {12, 25, 10};
+    int totalWidth = 51;
+    
+    bool headerPrinted = false;
+    
+    const vector<int>& myClasses = viewOfTeacher(currentUserSym).classes;
+    for (int r = 0; r < (int)myClasses.size(); r++) {
+        int i = myClasses[r];
+        if (classes[i].isActive) {
+            if (!headerPrinted) {
+                drawTableHeader(headers, 3, colWidths, totalWidth);
+                headerPrinted = true;
+            }
+            hasClasses = true;
+            char studentStr[10];
+            sprintf(studentStr, "%d", (int)classes[i].enrolledStudents.size());
+            const char* row[] = {symbolName(classes[i].classId), classes[i].className, studentStr};
+            drawTableRow(row, 3, colWidths, totalWidth);
+        }
+    }
     
-    drawBoxTop();
-    drawBoxLine("Interactive RSA Demonstration", BOX_WIDTH, COLOR_HEADER);
-    drawBoxBottom();
+    if (hasClasses) {
+        drawTableBottom(3, colWidths, totalWidth);
+    } else {
+        drawBoxTop();
+        drawBoxLine("[!] Create a class first!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
     
+    char classId[20];
     cout << endl;
     setColor(COLOR_INFO);
-    cout << "                                                    Enter a message to encrypt (max 50 chars): ";
+    cout << "                                                    Enter Class ID: ";
     resetColor();
+    cin.getline(classId, 20);
     
-    char message[51];
-    cin.getline(message, 51);
+    int classIdx = findClass(classId);
+    if (classIdx == -1 || classes[classIdx].teacherName != currentUserSym) {
+        drawBoxTop();
+        drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
     
-    if (strlen(message) == 0) {
+    char title[100];
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter Exam Title: ";
+    resetColor();
+    cin.getline(title, 100);
+    
+    displaySectionHeader("EXAM CONTENT");
+    setColor(COLOR_INFO);
+    cout << "                                                    Type 'END' on a new line to finish:\n\n";
+    resetColor();
+    
+    // Capped so the ciphertext fits ExamPayload::encryptedContent.
+    const int maxContent = cipherCapacity(sizeof(ExamPayload::encryptedContent));
+    char content[2000];
+    content[0] = '\0';
+    char line[200];
+    while (cin.getline(line, 200)) {
+        if (strcmp(line, "END") == 0) break;
+        strncat(content, line, maxContent - strlen(content));
+        strncat(content, "\n", maxContent - strlen(content));
+    }
+    
+    if (strlen(content) == 0) {
         drawBoxTop();
-        drawBoxLine("No message entered!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("[!] Content cannot be empty!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    int duration;
+    setColor(COLOR_INFO);
+    cout << "\n                                                    Duration (minutes): ";
+    resetColor();
+    cin >> duration;
+    cin.ignore();
+    
+    if (duration <= 0) {
+        drawBoxTop();
+        drawBoxLine("[!] Duration must be positive!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+
+    char opensText[40], closesText[40];
+    long long opensAt, closesAt;
+    setColor(COLOR_INFO);
+    cout << "\n                                                    Opens at (YYYY-MM-DD HH:MM, blank = now): ";
+    resetColor();
+    cin.getline(opensText, 40);
+    setColor(COLOR_INFO);
+    cout << "                                                    Closes at (YYYY-MM-DD HH:MM, blank = never): ";
+    resetColor();
+    cin.getline(closesText, 40);
+
+    if (!parseScheduleTime(opensText, opensAt) || !parseScheduleTime(closesText, closesAt) ||
+        (closesAt != 0 && closesAt <= max(opensAt, (long long)time(0)))) {
+        drawBoxTop();
+        drawBoxLine("[!] Invalid release or close time!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    
+    int newRow = addExam(classIdx, title, content, duration, opensAt, closesAt, currentUserSym);
+    if (newRow == -1) {
+        drawBoxTop();
+        drawBoxLine("[!] Your account was not found!", BOX_WIDTH, COLOR_ERROR);
         drawBoxBottom();
         pauseScreen();
         return;
     }
     
     cout << endl;
-    displaySectionHeader("STEP 1: ORIGINAL MESSAGE");
     drawBoxTop();
-    drawBoxLine(message, BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxBottom();
+    drawBoxLine("EXAM CREATED SUCCESSFULLY!", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
     
-    // Show character-by-character encryption
-    displaySectionHeader("STEP 2: CHARACTER ENCRYPTION");
+    char buffer[60];
+    sprintf(buffer, "Exam ID: %s", symbolName(exams[newRow].id));
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+    sprintf(buffer, "Title: %s", title);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    sprintf(buffer, "Class: %s", classes[classIdx].className);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    sprintf(buffer, "Duration: %d minutes", duration);
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    char when[20];
+    if (opensAt != 0) {
+        formatScheduleTime(opensAt, when, sizeof(when));
+        sprintf(buffer, "Opens: %s", when);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    }
+    if (closesAt != 0) {
+        formatScheduleTime(closesAt, when, sizeof(when));
+        sprintf(buffer, "Closes: %s", when);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    }
     
-    const char* headers[] = {"Char", "ASCII", "Encrypted"};
-    int colWidths[] = {8, 12, 20};
-    int totalWidth = 44;
+    drawBoxMiddle();
+    drawBoxLine("Content encrypted with RSA", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxLine("Digital signature applied", BOX_WIDTH, COLOR_SUCCESS);
     
-    drawTableHeader(headers, 3, colWidths, totalWidth);
+    drawBoxMiddle();
+    drawBoxLine("[!] Don't forget to distribute the key!", BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+    pauseScreen();
+}
+
+void viewMyExams() {
+    clearScreen();
+    displayExamBanner();
+    displayHeader("MY EXAMS");
     
-    char encrypted[2000];
-    encrypted[0] = '\0';
-    char temp[20];
+    bool found = false;
     
-    int len = strlen(message);
-    for (int i = 0; i < len && i < 10; i++) {  // Show first 10 chars
-        long long m = (long long)(unsigned char)message[i];
-        long long c = modPow(m, keys.e, keys.n);
-        
-        char charStr[10], asciiStr[15], encStr[25];
-        sprintf(charStr, "%c", message[i]);
-        sprintf(asciiStr, "%lld", m);
-        sprintf(encStr, "%lld", c);
+    const char* headers[] = {"ID", "Title", "Class", "Duration", "Key Sent", "Access", "Subs"};
+    int colWidths[] = {10, 18, 12, 10, 9, 8, 6};
+    int totalWidth = 78;
+    
+    bool headerPrinted = false;
+    
+    const vector<int>& myExams = viewOfTeacher(currentUserSym).exams;
+    for (int r = 0; r < (int)myExams.size(); r++) {
+        int i = myExams[r];
+        if (!headerPrinted) {
+            cout << endl;
+            drawTableHeader(headers, 7, colWidths, totalWidth);
+            headerPrinted = true;
+        }
         
-        const char* row[] = {charStr, asciiStr, encStr};
-        drawTableRow(row, 3, colWidths, totalWidth);
+        found = true;
+        char durStr[15], accessStr[10], subStr[10];
+        sprintf(durStr, "%d min", exams[i].duration);
+        sprintf(accessStr, "%d", setSize(exams[i].approvedStudents));
+        {
+            // Timed-out attempts are submitted from the timer thread.
+            TableGuard guard(TABLE_ASSIGNMENTS, 0);
+            sprintf(subStr, "%d", submissionCount(exams[i].id));
+        }
         
-        sprintf(temp, "%lld ", c);
-        strcat(encrypted, temp);
+        const char* row[] = {
+            symbolName(exams[i].id), 
+            examPayloads[i].title, 
+            examPayloads[i].assignedClassName,
+            durStr,
+            exams[i].keyDistributed ? "Yes" : "No",
+            accessStr,
+            subStr
+        };
+        drawTableRow(row, 7, colWidths, totalWidth);
     }
     
-    if (len > 10) {
-        const char* ellipsis[] = {"...", "...", "..."};
-        drawTableRow(ellipsis, 3, colWidths, totalWidth);
+    if (found) {
+        drawTableBottom(7, colWidths, totalWidth);
+    } else {
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("No exams created yet", BOX_WIDTH, COLOR_INFO);
+        drawBoxBottom();
     }
     
-    drawTableBottom(3, colWidths, totalWidth);
-    
-    // Full encryption
-    encryptMessage(message, encrypted, keys.e, keys.n);
+    pauseScreen();
+}
+
+
+// Adds the key row for one student, or for the whole class when student is
+// NO_SYMBOL, and lists who should get an envelope.
+int insertKeyDist(int examIdx, Symbol teacher, Symbol student, vector<Symbol>& recipients) {
+    TableGuard guard(TABLE_CLASSES | TABLE_ASSIGNMENTS, TABLE_EXAMS | TABLE_KEYDIST);
+    int newRow = allocRow(keyDist, keyDistCount);
+    keyDist[newRow].id = generateId("KEY");
+    keyDist[newRow].examId = exams[examIdx].id;
+    strncpy(keyDist[newRow].examTitle, examPayloads[examIdx].title, 99);
+    keyDist[newRow].examTitle[99] = '\0';
+    keyDist[newRow].classId = exams[examIdx].assignedClassId;
+    strncpy(keyDist[newRow].className, examPayloads[examIdx].assignedClassName, 99);
+    keyDist[newRow].className[99] = '\0';
+    keyDist[newRow].fromTeacher = teacher;
+    keyDist[newRow].toStudent = student == NO_SYMBOL ? intern("CLASS") : student;
+    
+    // --- SECURE KEYS ---
+    // Only the public half goes in the row; d travels in envelopes.
+    keyDist[newRow].publicKeyE = examPayloads[examIdx].exam_e;
+    keyDist[newRow].publicKeyN = examPayloads[examIdx].exam_n;
+    keyDist[newRow].isClassWide = student == NO_SYMBOL;
+    
+    if (student == NO_SYMBOL) {
+        int classIdx = findClass(exams[examIdx].assignedClassId);
+        if (classIdx != -1) {
+            setUnionSorted(exams[examIdx].approvedStudents, classes[classIdx].enrolledStudents);
+            recipients = classes[classIdx].enrolledStudents;
+        }
+        exams[examIdx].keyDistributed = true;
+    } else {
+        setAdd(exams[examIdx].approvedStudents, student);
+        recipients.push_back(student);
+    }
     
-    displaySectionHeader("STEP 3: ENCRYPTED MESSAGE");
-    cout << endl;
-    setColor(COLOR_BOX);
-    centerText("+----------------------------------------------------------+");
-    resetColor();
-    setColor(COLOR_ERROR);
-    // Print encrypted in chunks
-    int eLen = strlen(encrypted);
-    for (int i = 0; i < eLen; i += 50) {
-        char chunk[51];
-        strncpy(chunk, encrypted + i, 50);
-        chunk[50] = '\0';
-        centerText(chunk);
+    indexKeyDist(newRow);
+    indexShardKey(newRow);
+    markShardDirty(examShard(examIdx));
+    persistAsync(SAVE_SHARDS);
+    return newRow;
+}
+
+// insertKeyDist() plus the envelopes; sealed is set to how many were made.
+int addKeyDist(int examIdx, Symbol teacher, Symbol student, int& sealed) {
+    vector<Symbol> recipients;
+    int newRow = insertKeyDist(examIdx, teacher, student, recipients);
+    Symbol keyId;
+    long long d;
+    string shardId;
+    {
+        TableGuard guard(TABLE_CLASSES | TABLE_EXAMS | TABLE_KEYDIST, 0);
+        keyId = keyDist[newRow].id;
+        d = examPayloads[examIdx].exam_d;
+        shardId = keyDistShard(newRow);
     }
-    resetColor();
-    setColor(COLOR_BOX);
-    centerText("+----------------------------------------------------------+");
-    resetColor();
+    sealed = wrapExamKey(keyId, shardId.c_str(), d, recipients);
+    return newRow;
+}
+
+void distributeExamKey() {
+    clearScreen();
+    displayRSABanner();
+    displayHeader("DISTRIBUTE EXAM KEY");
     
-    // Decryption
-    displaySectionHeader("STEP 4: DECRYPTION");
-    char decrypted[2000];
-    decryptMessage(encrypted, decrypted, keys.d, keys.n);
+    displaySectionHeader("YOUR EXAMS");
     
-    drawBoxTop();
-    drawBoxLine("Decrypted Message:", BOX_WIDTH, COLOR_HEADER);
-    drawBoxLine(decrypted, BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxBottom();
+    bool hasExams = false;
+    const char* headers[] = {"Exam ID", "Title", "Key Status"};
+    int colWidths[] = {12, 25, 12};
+    int totalWidth = 53;
     
-    // Verify
-    cout << endl;
-    if (strcmp(message, decrypted) == 0) {
-        drawBoxTop(40);
-        drawBoxLine("VERIFICATION: SUCCESS!", 40, COLOR_SUCCESS);
-        drawBoxLine("Original = Decrypted", 40, COLOR_SUCCESS);
-        drawBoxBottom(40);
+    bool headerPrinted = false;
+    
+    const vector<int>& myExams = viewOfTeacher(currentUserSym).exams;
+    for (int r = 0; r < (int)myExams.size(); r++) {
+        int i = myExams[r];
+        if (exams[i].isActive) {
+            if (!headerPrinted) {
+                drawTableHeader(headers, 3, colWidths, totalWidth);
+                headerPrinted = true;
+            }
+            hasExams = true;
+            const char* row[] = {
+                symbolName(exams[i].id),
+                examPayloads[i].title,
+                exams[i].keyDistributed ? "Sent" : "Pending"
+            };
+            drawTableRow(row, 3, colWidths, totalWidth);
+        }
+    }
+    
+    if (hasExams) {
+        drawTableBottom(3, colWidths, totalWidth);
     } else {
-        drawBoxTop(40);
-        drawBoxLine("VERIFICATION: FAILED!", 40, COLOR_ERROR);
-        drawBoxBottom(40);
+        drawBoxTop();
+        drawBoxLine("[!] No exams to distribute keys for", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
     }
     
-    pauseScreen();
-}
+    char examId[20];
+    cout << endl;
+    setColor(COLOR_INFO);
+    cout << "                                                    Enter Exam ID: ";
+    resetColor();
+    cin.getline(examId, 20);
+    
+    int examIdx = findExam(examId);
+    if (examIdx == -1 || exams[examIdx].teacherName != currentUserSym) {
+        drawBoxTop();
+        drawBoxLine("[!] Exam not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
+    if (!hasExamKey(examPayloads[examIdx])) {
+        drawBoxTop();
+        drawBoxLine("[!] This exam has no key to distribute!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxBottom();
+        pauseScreen();
+        return;
+    }
 
-//  NEW FEATURE: DIGITAL SIGNATURE DEMO
-void digitalSignatureDemo() {
-    clearScreen();
-    displayRSABanner();
-    displayHeader("DIGITAL SIGNATURE DEMO");
-    
-    int userIdx = findUser(currentUser);
-    RSAKeys& keys = users[userIdx].keys;
-    
-    drawBoxTop();
-    drawBoxLine("Digital Signature Demonstration", BOX_WIDTH, COLOR_HEADER);
-    drawBoxMiddle();
-    drawBoxLineLeft("Sign with PRIVATE key (d)", BOX_WIDTH, COLOR_INFO);
-    drawBoxLineLeft("Verify with PUBLIC key (e)", BOX_WIDTH, COLOR_INFO);
-    drawBoxBottom();
+    cout << endl;
+    drawBoxTop(40);
+    drawBoxLine("Distribution Options", 40, COLOR_HEADER);
+    drawBoxMiddle(40);
+    drawBoxLineLeft("1. Send to ENTIRE CLASS", 40, COLOR_INFO);
+    drawBoxLineLeft("2. Send to INDIVIDUAL", 40, COLOR_INFO);
+    drawBoxLineLeft("0. Cancel", 40, COLOR_DEFAULT);
+    drawBoxBottom(40);
     
     cout << endl;
     setColor(COLOR_INFO);
-    cout << "                                                    Enter a document to sign: ";
+    cout << "                                                    Choice: ";
     resetColor();
     
-    char document[200];
-    cin.getline(document, 200);
+    int choice;
+    cin >> choice;
+    cin.ignore();
     
-    if (strlen(document) == 0) {
-        strcpy(document, "This is a test document");
+    if (choice == 0) {
+        pauseScreen();
+        return;
     }
     
-    displaySectionHeader("STEP 1: ORIGINAL DOCUMENT");
-    drawBoxTop();
-    drawBoxLine(document, BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxBottom();
+    int userIdx = findUser(currentUser);
     
-    // Create hash
-    displaySectionHeader("STEP 2: CALCULATE HASH");
-    long long hash = 0;
-    int len = strlen(document);
-    for (int i = 0; i < len; i++) {
-        hash = (hash * 31 + document[i]) % 1000000007;
+    if (choice == 1) {
+        int sealed;
+        long long started = monotonicMs();
+        int newRow = addKeyDist(examIdx, currentUserSym, NO_SYMBOL, sealed);
+        long long elapsed = monotonicMs() - started;
+        
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("KEY SENT TO ENTIRE CLASS!", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxMiddle();
+        
+        char buffer[60];
+        sprintf(buffer, "Exam: %s", examPayloads[examIdx].title);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+        sprintf(buffer, "Class: %s", examPayloads[examIdx].assignedClassName);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        
+        drawBoxMiddle();
+        drawBoxLine("PUBLIC KEY DISTRIBUTED", BOX_WIDTH, COLOR_HEADER);
+        sprintf(buffer, "e = %lld", keyDist[newRow].publicKeyE);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
+        sprintf(buffer, "n = %lld", keyDist[newRow].publicKeyN);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxMiddle();
+        sprintf(buffer, "Private key sealed for %d students in %lld ms", sealed, elapsed);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+        
+        drawBoxBottom();
+        
+    } else if (choice == 2) {
+        char studentName[50];
+        setColor(COLOR_INFO);
+        cout << "\n                                                    Enter student username: ";
+        resetColor();
+        cin.getline(studentName, 50);
+        
+        if (!isStudentInClass(lookupSymbol(studentName), exams[examIdx].assignedClassId)) {
+            drawBoxTop();
+            drawBoxLine("[!] Student not in this class!", BOX_WIDTH, COLOR_ERROR);
+            drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+        
+        int sealed;
+        addKeyDist(examIdx, currentUserSym, lookupSymbol(studentName), sealed);
+        
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("KEY SENT TO STUDENT!", BOX_WIDTH, COLOR_SUCCESS);
+        drawBoxMiddle();
+        
+        char buffer[60];
+        sprintf(buffer, "Student: %s", studentName);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+        sprintf(buffer, "Exam: %s", examPayloads[examIdx].title);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxLineLeft(sealed == 1 ? "Private key sealed with the student's RSA key" : "No account to seal the private key for",
+                        BOX_WIDTH, sealed == 1 ? COLOR_SUCCESS : COLOR_ERROR);
+        
+        drawBoxBottom();
     }
     
-    char buffer[100];
-    sprintf(buffer, "Hash(document) = %lld", hash);
-    drawBoxTop();
-    drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
-    drawBoxBottom();
-    
-    // Sign
-    displaySectionHeader("STEP 3: CREATE SIGNATURE");
-    long long signature = createSignature(document, keys.d, keys.n);
-    
-    sprintf(buffer, "Signature = Hash^d mod n");
-    drawBoxTop();
-    drawBoxLine(buffer, BOX_WIDTH, COLOR_HEADER);
-    sprintf(buffer, "Signature = %lld", signature);
-    drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxBottom();
-    
-    // Verify
-    displaySectionHeader("STEP 4: VERIFY SIGNATURE");
-    bool verified = verifySignature(document, signature, keys.e, keys.n);
-    
-    drawBoxTop();
-    drawBoxLine("Verification: Signature^e mod n = Hash?", BOX_WIDTH, COLOR_HEADER);
-    if (verified) {
-        drawBoxLine("SIGNATURE VALID!", BOX_WIDTH, COLOR_SUCCESS);
-    } else {
-        drawBoxLine("SIGNATURE INVALID!", BOX_WIDTH, COLOR_ERROR);
+    pauseScreen();
+}
+void markKeysRead(Symbol student, const vector<int>& rows) {
+    TableGuard guard(TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS, TABLE_KEYDIST);
+    for (int r = 0; r < (int)rows.size(); r++) {
+        if (setAdd(keyDist[rows[r]].readers, student)) markShardDirty(keyDistShard(rows[r]));
     }
-    drawBoxBottom();
-    
-    // Tamper test
-    cout << endl;
-    drawBoxTop(50);
-    drawBoxLine("TAMPER TEST", 50, COLOR_INFO);
-    drawBoxMiddle(50);
-    drawBoxLineLeft("Modified document:", 50, COLOR_DEFAULT);
+    persistAsync(SAVE_SHARDS);
+}
+
+void viewReceivedKeys() {
+    clearScreen();
+    displayRSABanner();
+    displayHeader("RECEIVED EXAM KEYS");
     
-    char tampered[200];
-    strcpy(tampered, document);
-    if (strlen(tampered) > 0) tampered[0] = tampered[0] + 1;
+    bool found = false;
+    vector<int> rows;
+    visibleKeys(currentUserSym, rows);
     
-    bool tamperedVerify = verifySignature(tampered, signature, keys.e, keys.n);
+    for (int r = 0; r < (int)rows.size(); r++) {
+        int i = rows[r];
+        found = true;
+        cout << endl;
+        drawBoxTop();
+        
+        if (setContains(keyDist[i].readers, currentUserSym)) {
+            drawBoxLine("[READ] Key Distribution", BOX_WIDTH, COLOR_DEFAULT);
+        } else {
+            drawBoxLine("[NEW] Key Distribution", BOX_WIDTH, COLOR_SUCCESS);
+        }
+        
+        drawBoxMiddle();
+        
+        char buffer[60];
+        sprintf(buffer, "Exam ID: %s", symbolName(keyDist[i].examId));
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_TITLE); // Highlighted in Magenta (Color 13)
+        sprintf(buffer, "From: %s", symbolName(keyDist[i].fromTeacher));
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+        sprintf(buffer, "Exam: %s", keyDist[i].examTitle);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        sprintf(buffer, "Class: %s", keyDist[i].className);
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        sprintf(buffer, "Type: %s", keyDist[i].isClassWide ? "Class-wide" : "Individual");
+        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+        bool sealed = findEnvelope(keyDist[i].id, currentUserSym) != NULL;
+        drawBoxLineLeft(sealed ? "Private key: sealed with your RSA key" : "Private key: not sealed for you, crack n",
+                        BOX_WIDTH, sealed ? COLOR_SUCCESS : COLOR_ERROR);
+        
+        drawBoxMiddle();
+        drawBoxLine("PUBLIC KEY FOR DECRYPTION", BOX_WIDTH, COLOR_HEADER);
+        drawBoxMiddle();
+        
+        sprintf(buffer, "e = %lld", keyDist[i].publicKeyE);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
+        sprintf(buffer, "n = %lld", keyDist[i].publicKeyN);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
+        
+        drawBoxBottom();
+    }
     
-    if (!tamperedVerify) {
-        drawBoxLine("Tamper detected correctly!", 50, COLOR_SUCCESS);
+    if (found) {
+        markKeysRead(currentUserSym, rows);
     } else {
-        drawBoxLine("Warning: Tamper not detected", 50, COLOR_ERROR);
+        cout << endl;
+        drawBoxTop();
+        drawBoxLine("No exam keys received yet", BOX_WIDTH, COLOR_INFO);
+        drawBoxBottom();
     }
-    drawBoxBottom(50);
     
     pauseScreen();
 }
+// Candidate divisors per executor task when factoring n.
+const int CRACK_GRAIN = 4096;
 
-// USER REGISTRATION & LOGIN 
-void  registerUser() {
-    clearScreen();
-    displayMainBanner();
-    displayHeader("REGISTER NEW USER");
+// Recent crackPrivateKey() results, direct-mapped by (n, e). Every student
+// of an exam cracks the same key, so a rush of attempts factors it once.
+const int CRACK_MEMO_SIZE = 256;
+
+struct CrackMemo {
+    long long n, e, d, p, q;
+    bool used;
+};
+
+CrackMemo crackMemo[CRACK_MEMO_SIZE];
+Mutex crackMemoLock = MUTEX_INIT;
+atomic<long long> crackMemoHits(0);
+
+int crackMemoSlot(long long n, long long e) {
+    unsigned long long h = (unsigned long long)n * 0x9E3779B97F4A7C15ULL ^ (unsigned long long)e;
+    return (int)((h >> 32) % CRACK_MEMO_SIZE);
+}
+
+struct CrackJob {
+    long long n;
+    atomic<long long> factor;
+    CancelToken found;
+};
+
+void crackRange(void* arg, int begin, int end) {
+    CrackJob* job = (CrackJob*)arg;
+    for (long long i = begin; i < end; i++) {
+        if ((i & 1023) == 0 && job->found.cancelled) return;
+        if (job->n % i == 0) {
+            job->factor = i;
+            job->found.cancelled = true;
+            return;
+        }
+    }
+}
+
+void crackPrivateKey(long long n, long long e, long long& d_out, long long& p_out, long long& q_out) {
+    p_out = 0;
+    q_out = 0;
+    int slot = crackMemoSlot(n, e);
+    mutexLock(crackMemoLock);
+    CrackMemo memo = crackMemo[slot];
+    mutexUnlock(crackMemoLock);
+    if (memo.used && memo.n == n && memo.e == e) {
+        crackMemoHits++;
+        p_out = memo.p;
+        q_out = memo.q;
+        if (p_out != 0) d_out = memo.d;
+        return;
+    }
     
-    if (userCount >= MAX_USERS) {
+    // 1. FACTORIZE N (Brute force factor finding)
+    // We look for a number 'i' that divides 'n' cleanly. The range up to
+    // sqrt(n) is split across the executor; for an RSA modulus p * q only the
+    // smaller prime lies in it, so the first task to find a divisor cancels
+    // the rest.
+    long long root = n >= 4 ? (long long)sqrtl((long double)n) : 1;
+    if (root > INT_MAX - 1) root = INT_MAX - 1;
+    while (root > 1 && root * root > n) root--;
+    while (root < INT_MAX - 1 && (root + 1) * (root + 1) <= n) root++;
+    CrackJob job;
+    job.n = n;
+    job.factor = 0;
+    parallelFor(2, (int)root + 1, CRACK_GRAIN, crackRange, &job, PRIORITY_INTERACTIVE, &job.found);
+    if (job.factor != 0) {
+        p_out = job.factor;
+        q_out = n / p_out;
+    }
+
+    memo.used = true;
+    memo.n = n;
+    memo.e = e;
+    memo.p = p_out;
+    memo.q = q_out;
+    memo.d = 0;
+    if (p_out != 0) {
+        // 2. CALCULATE PHI (Euler's Totient)
+        long long phi = (p_out - 1) * (q_out - 1);
+
+        // 3. CALCULATE PRIVATE KEY (d)
+        // d is the modular multiplicative inverse of e mod phi
+        d_out = modInverse(e, phi);
+        memo.d = d_out;
+    }
+    mutexLock(crackMemoLock);
+    crackMemo[slot] = memo;
+    mutexUnlock(crackMemoLock);
+}
+
+//  TIMED ATTEMPTS
+// Opening an exam starts an attempt. Its deadline is the exam duration from
+// now, cut short by the exam's close time, and is a timer in attemptWheel.
+// The answer is collected into the attempt as it is typed. The student's
+// SUBMIT or the deadline, whichever comes first, ends the attempt; at the
+// deadline the timer thread submits whatever was collected. attemptsLock
+// covers everything here and is taken after any TableGuard, never before.
+long long attemptKey(Symbol student, Symbol examId) {
+    return ((long long)student << 32) | (unsigned)examId;
+}
+
+// Whether an exam takes attempts at time now. Caller holds TABLE_EXAMS.
+AttemptResult examWindow(int examIdx, long long now) {
+    if (exams[examIdx].opensAt != 0 && now < exams[examIdx].opensAt) return ATTEMPT_NOT_OPEN;
+    if (exams[examIdx].closesAt != 0 && now >= exams[examIdx].closesAt) return ATTEMPT_CLOSED;
+    return ATTEMPT_STARTED;
+}
+
+// Starts the student's attempt at an exam, or finds the one already running.
+AttemptResult startAttempt(Symbol student, Symbol examId, long long e, long long n, long long d, long long& deadline) {
+    TableGuard guard(TABLE_EXAMS, 0);
+    int examIdx = findExam(examId);
+    if (examIdx == -1) return ATTEMPT_NO_EXAM;
+    long long now = time(0);
+    AttemptResult window = examWindow(examIdx, now);
+    if (window != ATTEMPT_STARTED) return window;
+    long long key = attemptKey(student, exams[examIdx].id);
+    mutexLock(attemptsLock);
+    unordered_map<long long, int>::iterator open = openAttempts.find(key);
+    if (open != openAttempts.end()) {
+        deadline = attempts[open->second].deadline;
+        mutexUnlock(attemptsLock);
+        return ATTEMPT_RESUMED;
+    }
+    deadline = now + exams[examIdx].duration * 60LL;
+    if (exams[examIdx].closesAt != 0 && exams[examIdx].closesAt < deadline) deadline = exams[examIdx].closesAt;
+    int row = allocRow(attempts, attemptCount);
+    Attempt& attempt = attempts[row];
+    attempt.student = student;
+    attempt.examId = exams[examIdx].id;
+    attempt.deadline = deadline;
+    attempt.e = e;
+    attempt.n = n;
+    attempt.d = d;
+    attempt.timer = wheelAdd(attemptWheel, deadline, row);
+    openAttempts[key] = row;
+    mutexUnlock(attemptsLock);
+    attemptsStarted++;
+    return ATTEMPT_STARTED;
+}
+
+enum DraftResult { DRAFT_ADDED, DRAFT_TOO_LONG, DRAFT_NO_ATTEMPT };
+
+// Adds text to a running attempt. Text that would take the answer past
+// MAX_ANSWER is refused whole and the attempt keeps running.
+DraftResult appendAnswer(Symbol student, Symbol examId, const char* text) {
+    mutexLock(attemptsLock);
+    unordered_map<long long, int>::iterator open = openAttempts.find(attemptKey(student, examId));
+    DraftResult result = DRAFT_NO_ATTEMPT;
+    if (open != openAttempts.end() && time(0) < attempts[open->second].deadline) {
+        string& answer = attempts[open->second].answer;
+        result = answer.size() + strlen(text) > MAX_ANSWER ? DRAFT_TOO_LONG : DRAFT_ADDED;
+        if (result == DRAFT_ADDED) answer += text;
+    }
+    mutexUnlock(attemptsLock);
+    return result;
+}
+
+// Ends a running attempt and hands back the collected answer and key. False
+// if there is none, because it was never started or already timed out.
+bool finishAttempt(Symbol student, Symbol examId, Attempt& out) {
+    mutexLock(attemptsLock);
+    unordered_map<long long, int>::iterator open = openAttempts.find(attemptKey(student, examId));
+    bool found = open != openAttempts.end();
+    if (found) {
+        int row = open->second;
+        out = attempts[row];
+        wheelCancel(attemptWheel, attempts[row].timer);
+        openAttempts.erase(open);
+        freeRow(attempts, row);
+    }
+    mutexUnlock(attemptsLock);
+    return found;
+}
+
+// Ends every attempt whose deadline has passed and submits its answer.
+void expireAttempts() {
+    vector<int> fired;
+    vector<Attempt> due;
+    mutexLock(attemptsLock);
+    wheelAdvance(attemptWheel, time(0), fired);
+    for (int i = 0; i < (int)fired.size(); i++) {
+        int row = fired[i];
+        due.push_back(attempts[row]);
+        openAttempts.erase(attemptKey(attempts[row].student, attempts[row].examId));
+        freeRow(attempts, row);
+    }
+    mutexUnlock(attemptsLock);
+    for (int i = 0; i < (int)due.size(); i++) {
+        queueSubmission(newSubmission(due[i].student, due[i].examId, due[i].answer.c_str(), due[i].e, due[i].n, due[i].d));
+        attemptsAutoSubmitted++;
+    }
+}
+
+THREAD_MAIN(timerMain) {
+    (void)arg;
+    mutexLock(attemptsLock);
+    while (!timerStop) {
+        conditionWait(timerWake, attemptsLock, TIMER_POLL_MS);
+        if (timerStop) break;
+        mutexUnlock(attemptsLock);
+        expireAttempts();
+        mutexLock(attemptsLock);
+    }
+    mutexUnlock(attemptsLock);
+    return 0;
+}
+
+void startTimers() {
+    wheelInit(attemptWheel, time(0));
+    timerStop = false;
+    timerRunning = startThread(timerThread, timerMain, NULL);
+}
+
+// Attempts still running are dropped.
+void stopTimers() {
+    if (!timerRunning) return;
+    mutexLock(attemptsLock);
+    timerStop = true;
+    conditionWakeAll(timerWake);
+    mutexUnlock(attemptsLock);
+    joinThread(timerThread);
+    timerRunning = false;
+}
+
+void attemptExam() {
+    clearScreen();
+    displayHeader("ATTEMPT EXAM");
+
+    // --- STEP 1: SELECT EXAM ---
+    char examId[20];
+    setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID to attempt: "; resetColor();
+    cin.getline(examId, 20);
+
+    int idx = findExam(examId);
+    if (idx == -1) {
         drawBoxTop();
-        drawBoxLine("[!] Maximum user limit reached!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("[!] Exam not found.", BOX_WIDTH, COLOR_ERROR);
         drawBoxBottom();
         pauseScreen();
         return;
     }
-    
-    char username[50], role[20], password[50];
-    
-    drawBoxTop();
-    drawBoxLine("Enter Registration Details", BOX_WIDTH, COLOR_HEADER);
-    drawBoxBottom();
-    
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Username: ";
-    resetColor();
-    cin.getline(username, 50);
-    
-    if (findUser(username) != -1) {
+    if (examWindow(idx, time(0)) != ATTEMPT_STARTED) {
+        char buffer[60], when[20];
+        if (examWindow(idx, time(0)) == ATTEMPT_NOT_OPEN) {
+            formatScheduleTime(exams[idx].opensAt, when, sizeof(when));
+            sprintf(buffer, "[!] This exam opens at %s.", when);
+        } else {
+            sprintf(buffer, "[!] This exam is closed.");
+        }
         drawBoxTop();
-        drawBoxLine("[!] Username already exists!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_ERROR);
         drawBoxBottom();
         pauseScreen();
         return;
     }
+
+    // --- STEP 2: OPEN KEY ENVELOPE ---
+    // The teacher sealed the exam's private key with this student's public
+    // key. Without an envelope the key has to be cracked from (N, E).
+    long long inputN, inputE, calcD;
+    if (unwrapExamKey(currentUserSym, exams[idx].id, inputN, inputE, calcD)) {
+        cout << endl;
+        drawBoxTop(60);
+        drawBoxLine("KEY ENVELOPE OPENED", 60, COLOR_SUCCESS);
+        drawBoxMiddle(60);
+        drawBoxLineLeft("The exam key was sealed with your public key", 60, COLOR_DEFAULT);
+        drawBoxLineLeft("and unwrapped with your private key.", 60, COLOR_DEFAULT);
+        drawBoxBottom(60);
+        setColor(COLOR_HEADER); cout << "                                                    PRIVATE KEY (d) RECOVERED: " << calcD << endl; Sleep(300);
+    } else {
+        // --- STEP 2: INPUT PUBLIC KEY ---
+        cout << endl;
+        drawBoxTop(60);
+        drawBoxLine("KEY CRACKING MODULE", 60, COLOR_HEADER);
+        drawBoxMiddle(60);
+        drawBoxLineLeft("Enter the Public Key (N, E) to break encryption.", 60, COLOR_DEFAULT);
+        drawBoxBottom(60);
+        cout << endl;
+
+        setColor(COLOR_INFO); cout << "                                                    Enter Modulus (N): "; resetColor();
+        if (!(cin >> inputN)) { cin.clear(); cin.ignore(); return; }
     
-    setColor(COLOR_INFO);
-    cout << "                                                    Role (teacher/student): ";
-    resetColor();
-    cin.getline(role, 20);
+        setColor(COLOR_INFO); cout << "                                                    Enter Exponent (E): "; resetColor();
+        if (!(cin >> inputE)) { cin.clear(); cin.ignore(); return; }
+        cin.ignore(); 
+
+        // --- STEP 3: CRACKING ANIMATION ---
+        cout << endl;
+        setColor(COLOR_TITLE); cout << "                                                    INITIATING FACTORIZATION ATTACK..." << endl; Sleep(500);
+        setColor(COLOR_DEFAULT); cout << "                                                    Targeting Modulus N = " << inputN << endl; Sleep(300);
     
-    int len = strlen(role);
-    for (int i = 0; i < len; i++) {
-        if (role[i] >= 'A' && role[i] <= 'Z') role[i] += 32;
+        long long calcP = 0, calcQ = 0;
+        if (inputN <= MAX_MODULUS) crackPrivateKey(inputN, inputE, calcD, calcP, calcQ);
+
+        if (calcP == 0) {
+            setColor(COLOR_ERROR); cout << "                                                    Attack Failed. N is prime or too large." << endl;
+            pauseScreen(); return;
+        }
+
+        setColor(COLOR_SUCCESS); cout << "                                                    Factors Found: P=" << calcP << ", Q=" << calcQ << endl; Sleep(300);
+        setColor(COLOR_INFO);    cout << "                                                    Calculated Phi(n) = " << (calcP-1)*(calcQ-1) << endl; Sleep(300);
+        setColor(COLOR_HEADER);  cout << "                                                    PRIVATE KEY (d) RECOVERED: " << calcD << endl; Sleep(800);
     }
-    
-    if (strcmp(role, "teacher") != 0 && strcmp(role, "student") != 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Invalid role!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxLine("Must be 'teacher' or 'student'", BOX_WIDTH, COLOR_DEFAULT);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+
+    // --- STEP 4: DECRYPT EXAM ---
+    char decryptedContent[5000];
+    // Use the CALCULATED private key (calcD) to unlock the exam
+    decryptMessage(examPayloads[idx].encryptedContent, decryptedContent, calcD, inputN);
+
+    // Basic validation: If decryption failed, it usually looks like garbage text
+    if (strlen(decryptedContent) == 0) {
+        setColor(COLOR_ERROR); cout << "\n                                                    Decryption yielded empty result." << endl;
+        pauseScreen(); return;
+    }
+
+    // The clock starts once the exam is readable.
+    Symbol examSym = exams[idx].id;
+    long long deadline;
+    AttemptResult started = startAttempt(currentUserSym, examSym, inputE, inputN, calcD, deadline);
+    if (started != ATTEMPT_STARTED && started != ATTEMPT_RESUMED) {
+        setColor(COLOR_ERROR); cout << "\n                                                    This exam is no longer taking attempts." << endl;
+        pauseScreen(); return;
     }
+
+    clearScreen();
+    displayHeader(examPayloads[idx].title);
     
-    setColor(COLOR_INFO);
-    cout << "                                                    Password: ";
-    resetColor();
-    cin.getline(password, 50);
+    drawBoxTop();
+    drawBoxLine("EXAM UNLOCKED", BOX_WIDTH, COLOR_SUCCESS);
+    drawBoxMiddle();
+    setColor(COLOR_DEFAULT);
+    cout << "  " << decryptedContent << endl;
+    cout << endl;
+    drawBoxMiddle();
+    char timeLine[80], when[20];
+    formatScheduleTime(deadline, when, sizeof(when));
+    sprintf(timeLine, "%s - submit by %s", started == ATTEMPT_RESUMED ? "Resuming your attempt" : "Timer started", when);
+    drawBoxLine(timeLine, BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+
+    // --- STEP 5: SUBMIT ANSWER ---
+    // Each line goes into the attempt at once, so a timeout keeps it.
+    cout << "\n                                                    Type your answer below (Type 'SUBMIT' on a new line to finish):\n";
+    cout << "                                                    ------------------------------------------------------------\n";
+    setColor(COLOR_SUCCESS);
     
-    if (strlen(password) < 4) {
+    bool timedOut = false;
+    char line[1000];
+    char entry[1002];
+    while (cin.getline(line, 1000)) {
+        if (strcmp(line, "SUBMIT") == 0) break;
+        sprintf(entry, "%s\n", line);
+        DraftResult added = appendAnswer(currentUserSym, examSym, entry);
+        if (added == DRAFT_NO_ATTEMPT) {
+            timedOut = true;
+            break;
+        }
+        if (added == DRAFT_TOO_LONG) {
+            setColor(COLOR_ERROR);
+            cout << "                                                    [!] Answer limit of " << MAX_ANSWER << " characters reached; line not added.\n";
+            setColor(COLOR_SUCCESS);
+        }
+    }
+    resetColor();
+
+    // --- STEP 6: ENCRYPT & SAVE SUBMISSION ---
+    Attempt finished;
+    if (timedOut || !finishAttempt(currentUserSym, examSym, finished)) {
+        cout << endl;
         drawBoxTop();
-        drawBoxLine("[!] Password too short!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxLine("Minimum 4 characters required", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxLine("TIME IS UP", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("Your answer up to the deadline was submitted automatically", BOX_WIDTH, COLOR_DEFAULT);
         drawBoxBottom();
         pauseScreen();
         return;
     }
-    
-    strncpy(users[userCount].username, username, 49); 
-    users[userCount].username[49] = '\0';
-    sprintf(users[userCount].password, "%lld", hashPassword(password));
-    strncpy(users[userCount].role, role, 19); 
-    users[userCount].role[19] = '\0';
-    generateRSAKeys(users[userCount].keys);
-    users[userCount].isActive = true;
-    
+    submitAnswer(currentUserSym, examSym, finished.answer.c_str(), inputE, inputN, calcD);
+
     cout << endl;
     drawBoxTop();
-    drawBoxLine("REGISTRATION SUCCESSFUL!", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxMiddle();
-    
-    char buffer[100];
-    sprintf(buffer, "Username: %s", username);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    sprintf(buffer, "Role: %s", role);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    
-    drawBoxMiddle();
-    drawBoxLine("RSA KEYS GENERATED", BOX_WIDTH, COLOR_HEADER);
-    drawBoxMiddle();
-    
-    sprintf(buffer, "Public Key (e): %lld", users[userCount].keys.e);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
-    sprintf(buffer, "Public Key (n): %lld", users[userCount].keys.n);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
-    sprintf(buffer, "Private Key (d): %lld [KEEP SECRET]", users[userCount].keys.d);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_ERROR);
-    
+    drawBoxLine("SUBMISSION ENCRYPTED & SENT", BOX_WIDTH, COLOR_SUCCESS);
     drawBoxBottom();
     
-    userCount++;
-    saveUsers();
     pauseScreen();
 }
-
-bool login() {
+void viewSubmissions() {
     clearScreen();
-    displayMainBanner();
-    displayHeader("USER LOGIN");
-    
-    char username[50], password[50], attemptedRole[20];
-    
-    drawBoxTop();
-    drawBoxLine("Enter Login Credentials", BOX_WIDTH, COLOR_HEADER);
-    drawBoxBottom();
-    
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Username: ";
-    resetColor();
-    cin.getline(username, 50);
+    displayHeader("STUDENT SUBMISSIONS");
+  
+    bool found = false;
     
-    setColor(COLOR_INFO);
-    cout << "                                                    Password: ";
-    resetColor();
-    cin.getline(password, 50);
+    const char* headers[] = {"ID", "Title", "Class", "Duration", "Key Sent", "Access", "Subs"};
+    int colWidths[] = {10, 18, 12, 10, 9, 8, 6};
+    int totalWidth = 78;
     
-    setColor(COLOR_INFO);
-    cout << "                                                    Login as (teacher/student): ";
-    resetColor();
-    cin.getline(attemptedRole, 20);
+    bool headerPrinted = false;
     
-    int len = strlen(attemptedRole);
-    for (int i = 0; i < len; i++) {
-        if (attemptedRole[i] >= 'A' && attemptedRole[i] <= 'Z') attemptedRole[i] += 32;
+    const vector<int>& myExams = viewOfTeacher(currentUserSym).exams;
+    for (int r = 0; r < (int)myExams.size(); r++) {
+        int i = myExams[r];
+        if (!headerPrinted) {
+            cout << endl;
+            drawTableHeader(headers, 7, colWidths, totalWidth);
+            headerPrinted = true;
+        }
+        
+        found = true;
+        char durStr[15], accessStr[10], subStr[10];
+        sprintf(durStr, "%d min", exams[i].duration);
+        sprintf(accessStr, "%d", setSize(exams[i].approvedStudents));
+        {
+            // Timed-out attempts are submitted from the timer thread.
+            TableGuard guard(TABLE_ASSIGNMENTS, 0);
+            sprintf(subStr, "%d", submissionCount(exams[i].id));
+        }
+        
+        const char* row[] = {
+            symbolName(exams[i].id), 
+            examPayloads[i].title, 
+            examPayloads[i].assignedClassName,
+            durStr,
+            exams[i].keyDistributed ? "Yes" : "No",
+            accessStr,
+            subStr
+        };
+        drawTableRow(row, 7, colWidths, totalWidth);
     }
     
-    int userIdx = findUser(username);
-    if (userIdx == -1) {
+    if (found) {
+        drawTableBottom(7, colWidths, totalWidth);
+    } else {
         cout << endl;
         drawBoxTop();
-        drawBoxLine("[!] User not found!", BOX_WIDTH, COLOR_ERROR);
+        drawBoxLine("No exams created yet", BOX_WIDTH, COLOR_INFO);
         drawBoxBottom();
-        pauseScreen();
-        return false;
     }
     
-    char hashedPass[50];
-    sprintf(hashedPass, "%lld", hashPassword(password));
+    // 2. Select Exam
+    char examId[20];
+    setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID to view responses: "; resetColor();
+    cin.getline(examId, 20);
+
+    // Verify ownership
+    int eIdx = findExam(examId);
+    int tIdx = findUser(currentUser); // Need teacher's real private key index
     
-    if (strcmp(users[userIdx].password, hashedPass) != 0) {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("[!] Incorrect password!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return false;
+    if (eIdx == -1 || exams[eIdx].teacherName != currentUserSym) {
+        cout << "                                                    Access Denied.\n"; pauseScreen(); return;
     }
-    
-    if (strcmp(users[userIdx].role, attemptedRole) != 0) {
+    if (!hasExamKey(examPayloads[eIdx])) {
+        cout << "                                                    This exam has no key; its answers cannot be decrypted.\n"; pauseScreen(); return;
+    }
+
+    bool foundSub = false;
+
+    // DECRYPT ANSWERS
+    // The student encrypted it with our Public Key, so we use our Private Key (d).
+    // All answers are decrypted up front as one batch on the executor, under
+    // a read lock because the timer thread may be adding submissions.
+    vector<DecryptJob> answers;
+    vector<Symbol> students;
+    vector<long long> signatures;
+    {
+        TableGuard guard(TABLE_ASSIGNMENTS, 0);
+        vector<Symbol> subIds;
+        if (exams[eIdx].id < (int)examSubmissions.size()) subIds = examSubmissions[exams[eIdx].id];
+        for (int s = 0; s < (int)subIds.size(); s++) {
+            // Submissions linked to this exam ID
+            int i = findAssignment(subIds[s]);
+            if (i == -1) continue;
+            answers.push_back(DecryptJob());
+            answers.back().ciphertext = assignmentPayloads[i].encryptedSubmission;
+            answers.back().d = examPayloads[eIdx].exam_d;
+            answers.back().n = examPayloads[eIdx].exam_n;
+            students.push_back(assignments[i].studentName);
+            signatures.push_back(assignmentPayloads[i].signature.signatureHash);
+        }
+        decryptAll(answers);
+    }
+
+    for (int s = 0; s < (int)answers.size(); s++) {
+        const char* decryptedAnswer = answers[s].plaintext;
+        foundSub = true;
+
         cout << endl;
         drawBoxTop();
-        drawBoxLine("ACCESS DENIED", BOX_WIDTH, COLOR_ERROR);
+        char header[100]; 
+        sprintf(header, "Student: %s", symbolName(students[s]));
+        drawBoxLine(header, BOX_WIDTH, COLOR_HEADER);
         drawBoxMiddle();
-        char buffer[60];
-        sprintf(buffer, "You are registered as: %s", users[userIdx].role);
-        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
-        sprintf(buffer, "Cannot login to: %s portal", attemptedRole);
-        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+        
+        cout << "                                                     Decrypted Response :\n" << endl;
+        setColor(COLOR_SUCCESS);
+        cout << "                                                    " << decryptedAnswer << endl;
+        resetColor();
+        
+        drawBoxMiddle();
+        
+        // Signature Verification (Optional cool feature)
+        // Verify using the calculated public key E (which is mathematically valid for verification here)
+        // For simplicity, we just show the hash
+        char sigStr[100];
+        sprintf(sigStr, "Digital Sig: %lld", signatures[s]);
+        drawBoxLine(sigStr, BOX_WIDTH, COLOR_INFO);
+        
         drawBoxBottom();
-        pauseScreen();
-        return false;
     }
-    
-    if (!users[userIdx].isActive) {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("[!] Account is deactivated!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return false;
+
+    if (!foundSub) {
+        cout << "\n                                                    No submissions received for this exam yet.\n";
     }
-    
-    strncpy(currentUser, username, 49); 
-    currentUser[49] = '\0';
-    strncpy(currentRole, users[userIdx].role, 19); 
-    currentRole[19] = '\0';
-    
-    cout << endl;
-    drawBoxTop();
-    drawBoxLine("LOGIN SUCCESSFUL!", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxMiddle();
-    
-    char buffer[60];
-    sprintf(buffer, "Welcome back, %s!", username);
-    drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
-    sprintf(buffer, "Role: %s", currentRole);
-    drawBoxLine(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    
-    drawBoxBottom();
-    
-    // Notifications
-    if (strcmp(currentRole, "teacher") == 0) {
-        int pending = countPendingRequests();
-        if (pending > 0) {
-            cout << endl;
-            drawBoxTop(50);
-            char notif[60];
-            sprintf(notif, "[!] %d pending access request(s)", pending);
-            drawBoxLine(notif, 50, COLOR_INFO);
-            drawBoxBottom(50);
+    pauseScreen();
+}
+//  MESSAGING
+// A message is encrypted with the recipient's public key and carries the
+// integrity hash of its plaintext, which the inbox checks after decrypting
+// with the recipient's private key. Sends and read marks go to messages.log
+// (see savemessagesList()), and the inbox reads a page at a time through the
+// recipient's Mailbox, newest first, so its cost follows the page and not
+// the table.
+// Each character encrypts to at most 7 ciphertext characters (n < 250000),
+// which must fit in Message::encryptedContent.
+const int MAX_MESSAGE_LENGTH = 256;
+const int INBOX_PAGE_SIZE = 10;
+
+enum SendResult { SEND_OK, SEND_NO_USER, SEND_EMPTY, SEND_TOO_LONG };
+
+SendResult sendMessage(Symbol from, const char* toName, const char* text, Symbol& messageId) {
+    int len = strlen(text);
+    if (len == 0) return SEND_EMPTY;
+    if (len > MAX_MESSAGE_LENGTH) return SEND_TOO_LONG;
+    Message m = Message();
+    long long e, n;
+    {
+        TableGuard guard(TABLE_USERS, 0);
+        int userIdx = findUser(toName);
+        if (userIdx == -1 || !users[userIdx].isActive) return SEND_NO_USER;
+        m.to = users[userIdx].username;
+        e = users[userIdx].keys.e;
+        n = users[userIdx].keys.n;
+    }
+    m.id = generateId("MSG");
+    m.from = from;
+    encryptMessage(text, m.encryptedContent, e, n);
+    m.integrityHash = calculateIntegrityHash(text);
+    {
+        // Rows of deleted messages are left for compaction rather than
+        // reused, so rebuilt mailboxes keep arrival order.
+        TableGuard guard(0, TABLE_MESSAGES);
+        int row = messageCount++;
+        messagesList.ensure(row) = m;
+        indexMessage(row);
+    }
+    if (appendMessageLog(messageRow(m))) persistAsync(SAVE_MESSAGES);
+    messageId = m.id;
+    return SEND_OK;
+}
+
+int unreadMessages(Symbol user) {
+    TableGuard guard(TABLE_MESSAGES, 0);
+    return mailboxOf(user).unread;
+}
+
+struct InboxEntry {
+    Symbol id;
+    Symbol from;
+    bool isRead;
+    bool intact;    // decrypted text matches the integrity hash
+    string text;
+};
+
+// Fills entries with one page of user's inbox, newest first, and returns the
+// number of messages in the inbox. The page is decrypted outside the locks.
+int inboxPage(Symbol user, int page, vector<InboxEntry>& entries) {
+    entries.clear();
+    vector<string> ciphertexts;
+    vector<long long> hashes;
+    long long d = 0, n = 0;
+    int total;
+    {
+        TableGuard guard(TABLE_USERS | TABLE_MESSAGES, 0);
+        int userIdx = findUser(user);
+        if (userIdx != -1) {
+            d = users[userIdx].keys.d;
+            n = users[userIdx].keys.n;
         }
-    } else {
-        int unreadKeys = countUnreadKeys();
-        if (unreadKeys > 0) {
-            cout << endl;
-            drawBoxTop(50);
-            char notif[60];
-            sprintf(notif, "[!] %d new exam key(s)", unreadKeys);
-            drawBoxLine(notif, 50, COLOR_INFO);
-            drawBoxBottom(50);
+        const vector<int>& rows = mailboxOf(user).messages;
+        total = (int)rows.size();
+        for (int k = total - 1 - page * INBOX_PAGE_SIZE; k >= 0 && (int)entries.size() < INBOX_PAGE_SIZE; k--) {
+            const Message& m = messagesList[rows[k]];
+            InboxEntry entry;
+            entry.id = m.id;
+            entry.from = m.from;
+            entry.isRead = m.isRead;
+            entries.push_back(entry);
+            ciphertexts.push_back(m.encryptedContent);
+            hashes.push_back(m.integrityHash);
         }
     }
-    
-    pauseScreen();
-    return true;
+    vector<DecryptJob> jobs(entries.size());
+    for (int i = 0; i < (int)jobs.size(); i++) {
+        jobs[i].ciphertext = ciphertexts[i].c_str();
+        jobs[i].d = d;
+        jobs[i].n = n;
+    }
+    decryptAll(jobs);
+    for (int i = 0; i < (int)entries.size(); i++) {
+        entries[i].intact = calculateIntegrityHash(jobs[i].plaintext) == hashes[i];
+        entries[i].text = jobs[i].plaintext;
+    }
+    return total;
 }
 
-// CLASS MANAGEMENT 
-void createClass() {
-    clearScreen();
-    displayClassBanner();
-    displayHeader("CREATE NEW CLASS");
-    
-    if (classCount >= MAX_CLASSES) {
-        drawBoxTop();
-        drawBoxLine("[!] Maximum class limit reached!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+// Marks one of user's messages read. False if it is not in their inbox.
+bool markMessageRead(Symbol user, Symbol messageId) {
+    bool found = false, changed = false;
+    {
+        TableGuard guard(0, TABLE_MESSAGES);
+        if (user < 0 || user >= (int)mailboxes.size()) return false;
+        Mailbox& box = mailboxes[user];
+        for (int k = (int)box.messages.size() - 1; k >= 0 && !found; k--) {
+            Message& m = messagesList[box.messages[k]];
+            if (m.id != messageId) continue;
+            found = true;
+            if (m.isRead) break;
+            m.isRead = true;
+            box.unread--;
+            changed = true;
+        }
     }
-    
-    char className[100];
-    
+    if (changed && appendMessageLog(string("R,") + symbolName(messageId) + "\n")) persistAsync(SAVE_MESSAGES);
+    return found;
+}
+
+// Deletes one of user's messages. False if it is not in their inbox.
+bool deleteMessage(Symbol user, Symbol messageId) {
+    bool found = false;
+    {
+        TableGuard guard(0, TABLE_MESSAGES);
+        if (user < 0 || user >= (int)mailboxes.size()) return false;
+        Mailbox& box = mailboxes[user];
+        for (int k = (int)box.messages.size() - 1; k >= 0 && !found; k--) {
+            int row = box.messages[k];
+            if (messagesList[row].id != messageId) continue;
+            found = true;
+            if (!messagesList[row].isRead) box.unread--;
+            box.messages.erase(box.messages.begin() + k);
+            freeRow(messagesList, row);
+        }
+    }
+    if (found && appendMessageLog(string("D,") + symbolName(messageId) + "\n")) persistAsync(SAVE_MESSAGES);
+    return found;
+}
+
+void sendMessageMenu() {
+    clearScreen();
+    displayMessageBanner();
+    displayHeader("SEND SECURE MESSAGE");
+
+    drawBoxTop();
+    drawBoxLine("Encrypted with the recipient's public key", BOX_WIDTH, COLOR_INFO);
+    drawBoxBottom();
+
+    char to[50], text[1000];
     cout << endl;
     setColor(COLOR_INFO);
-    cout << "                                                    Enter Class Name: ";
+    cout << "                                                    To (username): ";
     resetColor();
-    cin.getline(className, 100);
-    
-    if (strlen(className) == 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Class name cannot be empty!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+    cin.getline(to, 50);
+    setColor(COLOR_INFO);
+    cout << "                                                    Message: ";
+    resetColor();
+    cin.getline(text, 1000);
+    if (cin.fail()) {
+        cin.clear();
+        cin.ignore(10000, '\n');
     }
-    
-    generateId(classes[classCount].classId, "CLS");
-    strncpy(classes[classCount].className, className, 99); 
-    classes[classCount].className[99] = '\0';
-    generateClassCode(classes[classCount].classCode);
-    strncpy(classes[classCount].teacherName, currentUser, 49); 
-    classes[classCount].teacherName[49] = '\0';
-    classes[classCount].studentCount = 0;
-    classes[classCount].examCount = 0;
-    classes[classCount].isActive = true;
-    
+
+    Symbol messageId;
+    SendResult result = sendMessage(currentUserSym, to, text, messageId);
     cout << endl;
     drawBoxTop();
-    drawBoxLine("CLASS CREATED SUCCESSFULLY!", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxMiddle();
-    
     char buffer[60];
-    sprintf(buffer, "Class ID: %s", classes[classCount].classId);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    sprintf(buffer, "Class Name: %s", className);
+    switch (result) {
+        case SEND_OK:
+            drawBoxLine("MESSAGE SENT!", BOX_WIDTH, COLOR_SUCCESS);
+            drawBoxMiddle();
+            sprintf(buffer, "Message ID: %s", symbolName(messageId));
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
+            sprintf(buffer, "To: %.40s", to);
+            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+            break;
+        case SEND_NO_USER: drawBoxLine("[!] Recipient not found!", BOX_WIDTH, COLOR_ERROR); break;
+        case SEND_EMPTY: drawBoxLine("[!] Message is empty!", BOX_WIDTH, COLOR_ERROR); break;
+        case SEND_TOO_LONG:
+            sprintf(buffer, "[!] Message is longer than %d characters!", MAX_MESSAGE_LENGTH);
+            drawBoxLine(buffer, BOX_WIDTH, COLOR_ERROR);
+            break;
+    }
+    drawBoxBottom();
+    pauseScreen();
+}
+
+void showMessage(const InboxEntry& entry) {
+    clearScreen();
+    displayMessageBanner();
+    displayHeader("MESSAGE");
+
+    char buffer[60];
+    drawBoxTop();
+    sprintf(buffer, "From: %s", symbolName(entry.from));
     drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    
-    drawBoxMiddle();
-    drawBoxLine("JOIN CODE", BOX_WIDTH, COLOR_HEADER);
-    drawBoxMiddle();
-    
-    // Large display of join code
-    char codeDisplay[20];
-    sprintf(codeDisplay, "[ %s ]", classes[classCount].classCode);
-    drawBoxLine(codeDisplay, BOX_WIDTH, COLOR_SUCCESS);
-    
+    sprintf(buffer, "Message ID: %s", symbolName(entry.id));
+    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
+    drawBoxLineLeft(entry.intact ? "Integrity: verified" : "Integrity: FAILED, message was altered",
+                    BOX_WIDTH, entry.intact ? COLOR_SUCCESS : COLOR_ERROR);
     drawBoxMiddle();
-    drawBoxLine("Share this code with students!", BOX_WIDTH, COLOR_INFO);
+    const int lineWidth = BOX_WIDTH - 4;
+    for (size_t start = 0; start < entry.text.size(); start += lineWidth) {
+        string line = entry.text.substr(start, lineWidth);
+        for (size_t c = 0; c < line.size(); c++) if (line[c] == '\n') line[c] = ' ';
+        drawBoxLineLeft(line.c_str(), BOX_WIDTH, COLOR_DEFAULT);
+    }
     drawBoxBottom();
-    
-    classCount++;
-    saveClasses();
+    markMessageRead(currentUserSym, entry.id);
     pauseScreen();
 }
 
-void viewMyClasses() {
-    clearScreen();
-    displayClassBanner();
-    displayHeader("MY CLASSES");
-    
-    bool found = false;
-    
-    for (int i = 0; i < classCount; i++) {
-        if (strcmp(classes[i].teacherName, currentUser) == 0 && classes[i].isActive) {
-            found = true;
-            cout << endl;
+void viewInbox() {
+    int page = 0;
+    while (true) {
+        vector<InboxEntry> entries;
+        int total = inboxPage(currentUserSym, page, entries);
+        int pages = (total + INBOX_PAGE_SIZE - 1) / INBOX_PAGE_SIZE;
+        if (page > 0 && page >= pages) {
+            page = pages - 1;
+            continue;
+        }
+
+        clearScreen();
+        displayMessageBanner();
+        displayHeader("MY INBOX");
+
+        if (total == 0) {
             drawBoxTop();
-            
-            char buffer[60];
-            drawBoxLine(classes[i].className, BOX_WIDTH, COLOR_HEADER);
-            drawBoxMiddle();
-            
-            sprintf(buffer, "ID: %s", classes[i].classId);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-            sprintf(buffer, "Join Code: %s", classes[i].classCode);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_SUCCESS);
-            sprintf(buffer, "Students: %d", classes[i].studentCount);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            sprintf(buffer, "Exams: %d", classes[i].examCount);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            
-            if (classes[i].studentCount > 0) {
-                drawBoxMiddle();
-                drawBoxLine("Enrolled Students:", BOX_WIDTH, COLOR_INFO);
-                for (int j = 0; j < classes[i].studentCount; j++) {
-                    sprintf(buffer, "  - %s", classes[i].enrolledStudents[j]);
-                    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-                }
-            }
-            
+            drawBoxLine("No messages yet", BOX_WIDTH, COLOR_INFO);
             drawBoxBottom();
+            pauseScreen();
+            return;
+        }
+
+        const char* headers[] = {"#", "From", "Status", "Message"};
+        int colWidths[] = {4, 14, 8, 27};
+        int totalWidth = 57;
+        drawTableHeader(headers, 4, colWidths, totalWidth);
+        for (int i = 0; i < (int)entries.size(); i++) {
+            char num[12];
+            sprintf(num, "%d", i + 1);
+            string preview = entries[i].intact ? entries[i].text : "[integrity check failed]";
+            for (size_t c = 0; c < preview.size(); c++) if (preview[c] == '\n') preview[c] = ' ';
+            const char* row[] = {num, symbolName(entries[i].from), entries[i].isRead ? "READ" : "NEW", preview.c_str()};
+            drawTableRow(row, 4, colWidths, totalWidth);
+        }
+        drawTableBottom(4, colWidths, totalWidth);
+
+        char buffer[60];
+        cout << endl;
+        drawBoxTop();
+        sprintf(buffer, "Page %d of %d  (%d messages, %d unread)", page + 1, pages, total, unreadMessages(currentUserSym));
+        drawBoxLine(buffer, BOX_WIDTH, COLOR_INFO);
+        drawBoxLine("# to open, D# to delete, N next, P previous, 0 back", BOX_WIDTH, COLOR_DEFAULT);
+        drawBoxBottom();
+
+        char choice[10];
+        cout << "  > ";
+        cin.getline(choice, 10);
+        if (choice[0] == 'n' || choice[0] == 'N') {
+            if (page + 1 < pages) page++;
+        } else if (choice[0] == 'p' || choice[0] == 'P') {
+            if (page > 0) page--;
+        } else if (choice[0] == 'd' || choice[0] == 'D') {
+            int pick = atoi(choice + 1);
+            if (pick >= 1 && pick <= (int)entries.size()) deleteMessage(currentUserSym, entries[pick - 1].id);
+        } else {
+            int pick = atoi(choice);
+            if (pick == 0) return;
+            if (pick >= 1 && pick <= (int)entries.size()) showMessage(entries[pick - 1]);
+        }
+    }
+}
+
+// DASHBOARD MENUS 
+
+void teacherDashboard() {
+    while (true) {
+        clearScreen();
+        displayTeacherBanner();
+        
+        char welcomeMsg[100];
+        sprintf(welcomeMsg, "Welcome, Teacher %s", currentUser);
+        drawBoxTop();
+        drawBoxLine(welcomeMsg, BOX_WIDTH, COLOR_INFO);
+        int unread = unreadMessages(currentUserSym);
+        char inboxMsg[60];
+        sprintf(inboxMsg, "Inbox: %d unread message%s", unread, unread == 1 ? "" : "s");
+        drawBoxLine(inboxMsg, BOX_WIDTH, unread > 0 ? COLOR_SUCCESS : COLOR_DEFAULT);
+        drawBoxBottom();
+
+        cout << endl;
+        displaySectionHeader("MAIN MENU");
+        
+        // Menu Options
+        cout << endl;
+        setColor(COLOR_INFO); cout << "                                                    1. "; resetColor(); cout << "Create New Class" << endl;
+        setColor(COLOR_INFO); cout << "                                                    2. "; resetColor(); cout << "View My Classes" << endl;
+        setColor(COLOR_INFO); cout << "                                                    3. "; resetColor(); cout << "Create New Exam" << endl;
+        setColor(COLOR_INFO); cout << "                                                    4. "; resetColor(); cout << "View My Exams" << endl;
+        setColor(COLOR_INFO); cout << "                                                    5. "; resetColor(); cout << "Distribute Exam Keys" << endl;
+        setColor(COLOR_INFO); cout << "                                                    6. "; resetColor(); cout << "View Student Submissions" << endl;
+        setColor(COLOR_INFO); cout << "                                                   10. "; resetColor(); cout << "Archive Exams & Classes" << endl;
+        setColor(COLOR_INFO); cout << "                                                   11. "; resetColor(); cout << "Import Class Roster (CSV)" << endl;
+        setColor(COLOR_INFO); cout << "                                                   12. "; resetColor(); cout << "Send Message" << endl;
+        setColor(COLOR_INFO); cout << "                                                   13. "; resetColor(); cout << "Inbox" << endl;
+        cout << "                                                    -----------------------------" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    7. "; resetColor(); cout << "View My RSA Key Info" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    8. "; resetColor(); cout << "RSA Encryption Demo" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    9. "; resetColor(); cout << "Digital Signature Demo" << endl;
+        cout << "                                                    -----------------------------" << endl;
+        setColor(COLOR_ERROR); cout << "                                                    0. "; resetColor(); cout << "Logout" << endl;
+
+        cout << endl;
+        drawBoxTop(BOX_WIDTH);
+        drawBoxLine("Enter your choice: ", BOX_WIDTH, COLOR_HEADER);
+        drawBoxBottom(BOX_WIDTH);
+        
+        int choice;
+        cout << "  > ";
+        cin >> choice;
+        cin.ignore();
+
+        switch (choice) {
+            case 1: createClass(); break;
+            case 2: viewMyClasses(); break;
+            case 3: createExam(); break;
+            case 4: viewMyExams(); break;
+            case 5: distributeExamKey(); break;
+            case 6: viewSubmissions(); break;
+            case 10: archiveMenu(); break;
+            case 11: importClassRoster(); break;
+            case 12: sendMessageMenu(); break;
+            case 13: viewInbox(); break;
+            case 7: viewMyKeyInfo(); break;
+            case 8: rsaEncryptionDemo(); break;
+            case 9: digitalSignatureDemo(); break;
+            case 0: return; // Returns to main()
+            default:
+                cout << "\n  Invalid choice!";
+                cin.get();
+        }
+    }
+}
+
+void studentDashboard() {
+    while (true) {
+        clearScreen();
+        displayStudentBanner();
+
+        char welcomeMsg[100];
+        sprintf(welcomeMsg, "Welcome, Student %s", currentUser);
+        drawBoxTop();
+        drawBoxLine(welcomeMsg, BOX_WIDTH, COLOR_SUCCESS);
+        int unread = unreadMessages(currentUserSym);
+        char inboxMsg[60];
+        sprintf(inboxMsg, "Inbox: %d unread message%s", unread, unread == 1 ? "" : "s");
+        drawBoxLine(inboxMsg, BOX_WIDTH, unread > 0 ? COLOR_INFO : COLOR_DEFAULT);
+        drawBoxBottom();
+
+        cout << endl;
+        displaySectionHeader("MAIN MENU");
+
+        // Menu Options
+        cout << endl;
+        setColor(COLOR_SUCCESS); cout << "                                                    1. "; resetColor(); cout << "Join a Class" << endl;
+        setColor(COLOR_SUCCESS); cout << "                                                    2. "; resetColor(); cout << "View Enrolled Classes" << endl;
+        setColor(COLOR_SUCCESS); cout << "                                                    3. "; resetColor(); cout << "View Received Exam Keys" << endl;
+        setColor(COLOR_SUCCESS); cout << "                                                    4. "; resetColor(); cout << "Attempt Exam" << endl; 
+        setColor(COLOR_SUCCESS); cout << "                                                    8. "; resetColor(); cout << "Send Message" << endl;
+        setColor(COLOR_SUCCESS); cout << "                                                    9. "; resetColor(); cout << "Inbox" << endl;
+        cout << "                                                    -----------------------------" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    5. "; resetColor(); cout << "View My RSA Key Info" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    6. "; resetColor(); cout << "RSA Encryption Demo" << endl;
+        setColor(COLOR_TITLE); cout << "                                                    7. "; resetColor(); cout << "Digital Signature Demo" << endl;
+        cout << "                                                    -----------------------------" << endl;
+        setColor(COLOR_ERROR); cout << "                                                    0. "; resetColor(); cout << "Logout" << endl;
+
+        cout << endl;
+        drawBoxTop(BOX_WIDTH);
+        drawBoxLine("Enter your choice: ", BOX_WIDTH, COLOR_HEADER);
+        drawBoxBottom(BOX_WIDTH);
+
+        int choice;
+        cout << "  > ";
+        cin >> choice;
+        cin.ignore();
+
+        switch (choice) {
+            case 1: joinClass(); break;
+            case 2: viewMyEnrolledClasses(); break;
+            case 3: viewReceivedKeys(); break;
+            case 4: attemptExam(); break;
+            case 8: sendMessageMenu(); break;
+            case 9: viewInbox(); break;
+            case 5: viewMyKeyInfo(); break;
+            case 6: rsaEncryptionDemo(); break;
+            case 7: digitalSignatureDemo(); break;
+            case 0: return; // Returns to main()
+            default:
+                cout << "\n  Invalid choice!";
+                cin.get();
+        }
+    }
+}
+
+//  SERVER MODE
+// "--server [port]" serves the student and teacher flows to many clients at
+// once over localhost TCP instead of the console. Each connection owns a
+// Session holding its login and its input/output buffers, so nothing touches
+// the console globals. One thread runs the event loop over non-blocking
+// sockets with WSAPoll (poll() off Windows). A request is one line and every
+// reply starts with OK or ERR:
+//   LOGIN <user> <password> <role>   LOGOUT   QUIT   HELP
+//   CLASSES   EXAMS   KEYS   JOIN <code>
+//   OPEN <examId> [<n> <e>]          DRAFT <examId> <text>
+//   SUBMIT <examId> <n> <e> <answer> SUBMISSIONS <examId>   STATS
+//   MAIL <user> <text>               INBOX [<page>]          READ <messageId>
+//   DELETE <messageId>
+// OPEN starts the timed attempt and replies "OK <seconds left> <exam text>",
+// after zero or more "WAIT <position>" lines while it is queued. Without
+// n and e it uses the student's key envelope.
+// DRAFT adds a line to the attempt, which is what gets submitted if time
+// runs out; SUBMIT appends its answer to the drafts and ends the attempt,
+// replying "OK <submission id>" once the submission is on disk. SUBMIT
+// seals with the key found at OPEN; its n and e are kept for compatibility.
+// INBOX lists a page of messages, newest first, as
+// "<id>,<from>,NEW|READ,OK|TAMPERED,<text>"; READ marks one read and replies
+// "OK <unread count>".
+// Listings reply "OK <count>" followed by count lines. Newlines inside exam
+// text, answers and messages travel as \n.
+#ifdef _WIN32
+typedef SOCKET SocketHandle;
+typedef WSAPOLLFD PollEntry;
+#define pollSockets WSAPoll
+#define closeSocket closesocket
+#else
+typedef int SocketHandle;
+typedef pollfd PollEntry;
+#define INVALID_SOCKET (-1)
+#define pollSockets poll
+#define closeSocket close
+#endif
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+const int DEFAULT_SERVER_PORT = 5050;
+const int MAX_REQUEST_LINE = 12000;   // an escaped 5000-char answer plus the command
+const int SERVER_IDLE_MS = 1000;      // poll timeout; idle ticks run compaction
+
+struct Session {
+    int id;              // never reused, unlike the row in sessions
+    SocketHandle sock;
+    string input;
+    string output;
+    Symbol user;         // NO_SYMBOL until LOGIN
+    char role[20];
+    bool closing;        // close once output is flushed and nothing is pending
+    bool hungUp;         // peer gone, drop now
+    bool readDone;       // peer sent EOF; it may still be reading replies
+    int openTickets;     // OPENs queued or running, see ADMISSION CONTROL
+    int submitsPending;  // SUBMITs not yet committed
+};
+
+bool setNonBlocking(SocketHandle sock) {
+#ifdef _WIN32
+    u_long on = 1;
+    return ioctlsocket(sock, FIONBIO, &on) == 0;
+#else
+    return fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+}
+
+bool socketWouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+string escapeLine(const char* text) {
+    string out;
+    for (; *text; text++) {
+        if (*text == '\\') out += "\\\\";
+        else if (*text == '\n') out += "\\n";
+        else if (*text != '\r') out += *text;
+    }
+    return out;
+}
+
+void unescapeLine(string_view text, char* out, int size) {
+    int len = 0;
+    for (size_t i = 0; i < text.size() && len < size - 1; i++) {
+        if (text[i] == '\\' && i + 1 < text.size()) {
+            i++;
+            out[len++] = text[i] == 'n' ? '\n' : text[i];
+        } else {
+            out[len++] = text[i];
         }
     }
-    
-    if (!found) {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("No classes created yet", BOX_WIDTH, COLOR_INFO);
-        drawBoxLine("Use 'Create Class' to get started!", BOX_WIDTH, COLOR_DEFAULT);
-        drawBoxBottom();
+    out[len] = '\0';
+}
+
+string_view nextWord(string_view& rest) {
+    while (!rest.empty() && rest[0] == ' ') rest.remove_prefix(1);
+    size_t end = rest.find(' ');
+    string_view word = rest.substr(0, end);
+    rest.remove_prefix(end == string_view::npos ? rest.size() : end);
+    return word;
+}
+
+void sendLine(Session& session, const string& line) {
+    session.output += line;
+    session.output += '\n';
+}
+
+void sendListing(Session& session, const vector<string>& lines) {
+    sendLine(session, "OK " + to_string(lines.size()));
+    for (int i = 0; i < (int)lines.size(); i++) sendLine(session, lines[i]);
+}
+
+void serveLogin(Session& session, string_view args) {
+    string username(nextWord(args)), password(nextWord(args)), role(nextWord(args));
+    for (int i = 0; i < (int)role.size(); i++) {
+        if (role[i] >= 'A' && role[i] <= 'Z') role[i] += 32;
+    }
+    int userIdx;
+    switch (checkLogin(username.c_str(), password.c_str(), role.c_str(), userIdx)) {
+        case LOGIN_NO_USER: sendLine(session, "ERR user not found"); return;
+        case LOGIN_BAD_PASSWORD: sendLine(session, "ERR incorrect password"); return;
+        case LOGIN_WRONG_ROLE: sendLine(session, string("ERR registered as ") + users[userIdx].role); return;
+        case LOGIN_INACTIVE: sendLine(session, "ERR account is deactivated"); return;
+        case LOGIN_OK: break;
     }
-    
-    pauseScreen();
+    session.user = users[userIdx].username;
+    strncpy(session.role, users[userIdx].role, 19);
+    session.role[19] = '\0';
+    sendLine(session, string("OK ") + session.role);
 }
 
-void joinClass() {
-    clearScreen();
-    displayClassBanner();
-    displayHeader("JOIN A CLASS");
-    
-    drawBoxTop();
-    drawBoxLine("Enter 6-digit class code", BOX_WIDTH, COLOR_INFO);
-    drawBoxBottom();
-    
-    char code[10];
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Class Code: ";
-    resetColor();
-    cin.getline(code, 10);
-    
-    for (int i = 0; i < classCount; i++) {
-        if (strcmp(classes[i].classCode, code) == 0 && classes[i].isActive) {
-            for (int j = 0; j < classes[i].studentCount; j++) {
-                if (strcmp(classes[i].enrolledStudents[j], currentUser) == 0) {
-                    cout << endl;
-                    drawBoxTop();
-                    drawBoxLine("[!] Already enrolled in this class!", BOX_WIDTH, COLOR_ERROR);
-                    drawBoxBottom();
-                    pauseScreen();
-                    return;
-                }
-            }
-            
-            if (classes[i].studentCount >= 50) {
-                cout << endl;
-                drawBoxTop();
-                drawBoxLine("[!] Class is full!", BOX_WIDTH, COLOR_ERROR);
-                drawBoxBottom();
-                pauseScreen();
-                return;
-            }
-            
-            strncpy(classes[i].enrolledStudents[classes[i].studentCount], currentUser, 49);
-            classes[i].enrolledStudents[classes[i].studentCount][49] = '\0';
-            classes[i].studentCount++;
-            saveClasses();
-            
-            cout << endl;
-            drawBoxTop();
-            drawBoxLine("SUCCESSFULLY JOINED CLASS!", BOX_WIDTH, COLOR_SUCCESS);
-            drawBoxMiddle();
-            
-            char buffer[60];
-            sprintf(buffer, "Class: %s", classes[i].className);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-            sprintf(buffer, "Teacher: %s", classes[i].teacherName);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            
-            drawBoxMiddle();
-            drawBoxLine("You will receive exam keys from this class", BOX_WIDTH, COLOR_INFO);
-            drawBoxBottom();
-            
-            pauseScreen();
-            return;
+void serveClasses(Session& session, bool teacher) {
+    TableGuard guard(TABLE_CLASSES | TABLE_KEYDIST, 0);
+    vector<string> lines;
+    if (teacher) {
+        const vector<int>& myClasses = viewOfTeacher(session.user).classes;
+        for (int r = 0; r < (int)myClasses.size(); r++) {
+            const Classroom& c = classes[myClasses[r]];
+            lines.push_back(string(symbolName(c.classId)) + "," + c.className + "," + c.classCode + "," + to_string(c.enrolledStudents.size()));
+        }
+    } else if (session.user < (int)studentViews.size()) {
+        const vector<Symbol>& enrolled = studentViews[session.user].classes;
+        for (int j = 0; j < (int)enrolled.size(); j++) {
+            int classIdx = findClass(enrolled[j]);
+            if (classIdx == -1) continue;
+            lines.push_back(string(symbolName(enrolled[j])) + "," + classes[classIdx].className + "," + symbolName(classes[classIdx].teacherName));
         }
     }
-    
-    cout << endl;
-    drawBoxTop();
-    drawBoxLine("[!] Invalid class code!", BOX_WIDTH, COLOR_ERROR);
-    drawBoxBottom();
-    pauseScreen();
+    sendListing(session, lines);
 }
 
-void viewMyEnrolledClasses() {
-    clearScreen();
-    displayClassBanner();
-    displayHeader("MY ENROLLED CLASSES");
-    
-    bool found = false;
-    
-    // Table setup
-    const char* headers[] = {"Class Name", "Teacher", "Students", "Exams"};
-    int colWidths[] = {20, 15, 10, 8};
-    int totalWidth = 57;
-    
-    bool headerPrinted = false;
-    
-    for (int i = 0; i < classCount; i++) {
-        for (int j = 0; j < classes[i].studentCount; j++) {
-            if (strcmp(classes[i].enrolledStudents[j], currentUser) == 0) {
-                if (!headerPrinted) {
-                    cout << endl;
-                    drawTableHeader(headers, 4, colWidths, totalWidth);
-                    headerPrinted = true;
-                }
-                
-                found = true;
-                char studentStr[15], examStr[10];
-                sprintf(studentStr, "%d", classes[i].studentCount);
-                sprintf(examStr, "%d", classes[i].examCount);
-                
-                const char* row[] = {classes[i].className, classes[i].teacherName, studentStr, examStr};
-                drawTableRow(row, 4, colWidths, totalWidth);
-                break;
+void serveExams(Session& session, bool teacher) {
+    TableGuard guard(TABLE_CLASSES | TABLE_EXAMS | TABLE_ASSIGNMENTS | TABLE_KEYDIST, 0);
+    vector<string> lines;
+    if (teacher) {
+        const vector<int>& myExams = viewOfTeacher(session.user).exams;
+        for (int r = 0; r < (int)myExams.size(); r++) {
+            int i = myExams[r];
+            lines.push_back(string(symbolName(exams[i].id)) + "," + examPayloads[i].title + "," + examPayloads[i].assignedClassName + "," + to_string(submissionCount(exams[i].id)));
+        }
+    } else if (session.user < (int)studentViews.size()) {
+        const vector<Symbol>& enrolled = studentViews[session.user].classes;
+        for (int j = 0; j < (int)enrolled.size(); j++) {
+            int classIdx = findClass(enrolled[j]);
+            if (classIdx == -1) continue;
+            const vector<Symbol>& assigned = classes[classIdx].assignedExams;
+            for (int k = 0; k < (int)assigned.size(); k++) {
+                int i = findExam(assigned[k]);
+                if (i == -1 || !exams[i].isActive) continue;
+                lines.push_back(string(symbolName(exams[i].id)) + "," + examPayloads[i].title + "," + examPayloads[i].assignedClassName + "," + to_string(exams[i].duration));
             }
         }
     }
-    
-    if (found) {
-        drawTableBottom(4, colWidths, totalWidth);
-    } else {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("Not enrolled in any classes", BOX_WIDTH, COLOR_INFO);
-        drawBoxLine("Use 'Join Class' to enroll!", BOX_WIDTH, COLOR_DEFAULT);
-        drawBoxBottom();
+    sendListing(session, lines);
+}
+
+void serveKeys(Session& session) {
+    vector<int> rows;
+    vector<string> lines;
+    {
+        TableGuard guard(TABLE_CLASSES | TABLE_KEYDIST, 0);
+        visibleKeys(session.user, rows);
+        for (int r = 0; r < (int)rows.size(); r++) {
+            const KeyDistribution& k = keyDist[rows[r]];
+            bool read = setContains(k.readers, session.user);
+            lines.push_back(string(symbolName(k.examId)) + "," + k.examTitle + "," + to_string(k.publicKeyE) + "," + to_string(k.publicKeyN) + (read ? ",READ" : ",NEW"));
+        }
     }
-    
-    pauseScreen();
+    markKeysRead(session.user, rows);
+    sendListing(session, lines);
 }
 
-// ============= EXAM MANAGEMENT =============
-void createExam() {
-    clearScreen();
-    displayExamBanner();
-    displayHeader("CREATE NEW EXAM");
-    
-    if (examCount >= MAX_EXAMS) {
-        drawBoxTop();
-        drawBoxLine("[!] Maximum exam limit reached!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+void serveJoin(Session& session, string_view args) {
+    string code(nextWord(args));
+    int classIdx;
+    switch (joinClassByCode(session.user, code.c_str(), classIdx)) {
+        case JOIN_INVALID_CODE: sendLine(session, "ERR invalid class code"); return;
+        case JOIN_ALREADY_ENROLLED: sendLine(session, "ERR already enrolled"); return;
+        case JOIN_OK: break;
     }
-    
-    displaySectionHeader("YOUR CLASSES");
-    
-    bool hasClasses = false;
-    const char* headers[] = {"Class ID", "Class Name", "Students"};
-    int colWidths[] = {12, 25, 10};
-    int totalWidth = 51;
-    
-    bool headerPrinted = false;
-    
-    for (int i = 0; i < classCount; i++) {
-        if (strcmp(classes[i].teacherName, currentUser) == 0 && classes[i].isActive) {
-            if (!headerPrinted) {
-                drawTableHeader(headers, 3, colWidths, totalWidth);
-                headerPrinted = true;
-            }
-            hasClasses = true;
-            char studentStr[10];
-            sprintf(studentStr, "%d", classes[i].studentCount);
-            const char* row[] = {classes[i].classId, classes[i].className, studentStr};
-            drawTableRow(row, 3, colWidths, totalWidth);
-        }
+    sendLine(session, string("OK ") + symbolName(classes[classIdx].classId) + " " + classes[classIdx].className);
+}
+
+// OPEN takes the exam's public key. Like attemptExam() it uses the
+// student's key envelope when there is one for that key, and otherwise
+// cracks it. SUBMIT reuses the key the attempt recorded at OPEN. A modulus above MAX_MODULUS is no exam key and is refused.
+bool examKeyFor(Symbol student, Symbol examId, long long& n, long long& e, long long& d) {
+    if (n > MAX_MODULUS) return false;
+    long long sealedN, sealedE;
+    if (unwrapExamKey(student, examId, sealedN, sealedE, d) && (n == 0 || (n == sealedN && e == sealedE))) {
+        n = sealedN;
+        e = sealedE;
+        return true;
     }
-    
-    if (hasClasses) {
-        drawTableBottom(3, colWidths, totalWidth);
-    } else {
-        drawBoxTop();
-        drawBoxLine("[!] Create a class first!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+    long long p, q;
+    crackPrivateKey(n, e, d, p, q);
+    return p != 0;
+}
+
+//  ADMISSION CONTROL
+// OPEN finds the exam key, starts the attempt and decrypts the exam. When a
+// class-wide key goes out every student sends OPEN at once, so OPEN never
+// runs on the event loop. It becomes a ticket in a bounded FIFO and runs on
+// the executor once its exam's token bucket has a token and fewer than two
+// tickets per worker are running. A ticket for another exam may pass a
+// throttled one. Waiting sessions get "WAIT <position>" lines, at most once
+// a second each. A full queue refuses OPEN with "ERR busy", and so does a
+// session that already has OPEN_TICKETS_PER_SESSION tickets out, so one
+// client cannot fill the queue. A modulus above MAX_MODULUS is refused
+// before it is queued. Since the crack is memoized, a rush on one exam
+// factors its key once.
+const int ADMISSION_QUEUE_LIMIT = 512;
+const int OPEN_TICKETS_PER_SESSION = 4;
+const int OPEN_RATE_PER_SECOND = 100;  // per exam; a full queue drains in ~5 s
+const int OPEN_BURST = 100;
+const int WAIT_UPDATE_MS = 1000;
+const int ADMISSION_POLL_MS = 5;       // poll timeout while tickets are out
+
+struct OpenTicket {
+    int sessionId;
+    Symbol student;
+    Symbol examId;
+    long long n, e;
+    long long queuedMs;
+    long long waitSentMs;
+    int waitPosition;    // last position sent, 0 = none yet
+    string reply;        // set by the worker
+};
+
+struct TokenBucket {
+    double tokens;
+    long long refilledMs;
+};
+
+deque<OpenTicket*> waitingOpens;      // event loop only
+vector<OpenTicket*> finishedOpens;    // under admissionLock
+Mutex admissionLock = MUTEX_INIT;
+unordered_map<Symbol, TokenBucket> openBuckets;
+int opensRunning = 0;
+int submitsOutstanding = 0;           // SUBMITs waiting for their commit
+long long opensAdmitted = 0;
+long long opensRefused = 0;
+LatencyHistogram openLatency;   // OPEN received to reply queued
+
+bool takeOpenToken(Symbol examId, long long now) {
+    unordered_map<Symbol, TokenBucket>::iterator found = openBuckets.find(examId);
+    if (found == openBuckets.end()) {
+        TokenBucket fresh = {(double)OPEN_BURST, now};
+        found = openBuckets.insert(make_pair(examId, fresh)).first;
     }
-    
-    char classId[20];
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Enter Class ID: ";
-    resetColor();
-    cin.getline(classId, 20);
-    
-    int classIdx = findClass(classId);
-    if (classIdx == -1 || strcmp(classes[classIdx].teacherName, currentUser) != 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Class not found!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+    TokenBucket& bucket = found->second;
+    bucket.tokens = min((double)OPEN_BURST, bucket.tokens + (now - bucket.refilledMs) * OPEN_RATE_PER_SECOND / 1000.0);
+    bucket.refilledMs = now;
+    if (bucket.tokens < 1) return false;
+    bucket.tokens -= 1;
+    return true;
+}
+
+// Unwraps or cracks the key, starts the attempt and decrypts the exam. Runs
+// on a worker.
+string openExam(Symbol student, Symbol examId, long long n, long long e) {
+    long long d = 0;
+    if (!examKeyFor(student, examId, n, e, d)) return "ERR N is prime or too large";
+    long long deadline;
+    AttemptResult started = startAttempt(student, examId, e, n, d, deadline);
+    if (started == ATTEMPT_NO_EXAM) return "ERR exam not found";
+    if (started == ATTEMPT_NOT_OPEN) return "ERR exam not open yet";
+    if (started == ATTEMPT_CLOSED) return "ERR exam closed";
+    char content[5000];
+    {
+        TableGuard guard(TABLE_EXAMS, 0);
+        int examIdx = findExam(examId);
+        if (examIdx == -1) return "ERR exam not found";
+        decryptMessage(examPayloads[examIdx].encryptedContent, content, d, n);
     }
-    
-    char title[100];
-    setColor(COLOR_INFO);
-    cout << "                                                    Enter Exam Title: ";
-    resetColor();
-    cin.getline(title, 100);
-    
-    displaySectionHeader("EXAM CONTENT");
-    setColor(COLOR_INFO);
-    cout << "                                                    Type 'END' on a new line to finish:\n\n";
-    resetColor();
-    
-    char content[2000];
-    content[0] = '\0';
-    char line[200];
-    while (cin.getline(line, 200)) {
-        if (strcmp(line, "END") == 0) break;
-        strncat(content, line, 1999 - strlen(content));
-        strncat(content, "\n", 1999 - strlen(content));
+    return "OK " + to_string(max(0LL, deadline - (long long)time(0))) + " " + escapeLine(content);
+}
+
+void runOpenTicket(void* arg, int begin, int end) {
+    (void)begin;
+    (void)end;
+    OpenTicket* ticket = (OpenTicket*)arg;
+    ticket->reply = openExam(ticket->student, ticket->examId, ticket->n, ticket->e);
+    mutexLock(admissionLock);
+    finishedOpens.push_back(ticket);
+    mutexUnlock(admissionLock);
+}
+
+void serveOpen(Session& session, string_view args) {
+    string examId(nextWord(args));
+    long long n = atoll(string(nextWord(args)).c_str());
+    long long e = atoll(string(nextWord(args)).c_str());
+    Symbol examSym = lookupSymbol(examId.c_str());
+    bool known;
+    {
+        TableGuard guard(TABLE_EXAMS, 0);
+        known = findExam(examSym) != -1;
     }
-    
-    if (strlen(content) == 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Content cannot be empty!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
+    if (!known) {
+        sendLine(session, "ERR exam not found");
         return;
     }
-    
-    int duration;
-    setColor(COLOR_INFO);
-    cout << "\n                                                    Duration (minutes): ";
-    resetColor();
-    cin >> duration;
-    cin.ignore();
-    
-    if (duration <= 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Duration must be positive!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
+    if (n > MAX_MODULUS) {
+        sendLine(session, "ERR N is prime or too large");
         return;
     }
-    
-    generateId(exams[examCount].id, "EXAM");
-    strncpy(exams[examCount].title, title, 99); 
-    exams[examCount].title[99] = '\0';
-    strncpy(exams[examCount].teacherName, currentUser, 49); 
-    exams[examCount].teacherName[49] = '\0';
-    strncpy(exams[examCount].assignedClassId, classId, 19); 
-    exams[examCount].assignedClassId[19] = '\0';
-    strncpy(exams[examCount].assignedClassName, classes[classIdx].className, 99); 
-    exams[examCount].assignedClassName[99] = '\0';
-    exams[examCount].duration = duration;
-    exams[examCount].isActive = true;
-    exams[examCount].approvedCount = 0;
-    exams[examCount].keyDistributed = false;
-    RSAKeys examKeys;
-    generateRSAKeys(examKeys); 
-
-    // Store them in the exam struct
-    exams[examCount].exam_n = examKeys.n;
-    exams[examCount].exam_e = examKeys.e;
-    exams[examCount].exam_d = examKeys.d;
-    exams[examCount].exam_p = examKeys.p;
-    exams[examCount].exam_q = examKeys.q;
-    int userIdx = findUser(currentUser);
-   encryptMessage(content, exams[examCount].encryptedContent, exams[examCount].exam_e, exams[examCount].exam_n);
-    
-    // Digital signature
-   long long sig = createSignature(content, users[userIdx].keys.d, users[userIdx].keys.n);
-    strncpy(exams[examCount].signature.signedBy, currentUser, 49);
-    exams[examCount].signature.signatureHash = sig;
-    exams[examCount].signature.isVerified = true;
-    
-    if (classes[classIdx].examCount < 20) {
-        strncpy(classes[classIdx].assignedExams[classes[classIdx].examCount], exams[examCount].id, 19);
-        classes[classIdx].assignedExams[classes[classIdx].examCount][19] = '\0';
-        classes[classIdx].examCount++;
+    if ((int)waitingOpens.size() >= ADMISSION_QUEUE_LIMIT || session.openTickets >= OPEN_TICKETS_PER_SESSION) {
+        opensRefused++;
+        sendLine(session, "ERR busy, try again");
+        return;
     }
-    
-    cout << endl;
-    drawBoxTop();
-    drawBoxLine("EXAM CREATED SUCCESSFULLY!", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxMiddle();
-    
-    char buffer[60];
-    sprintf(buffer, "Exam ID: %s", exams[examCount].id);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-    sprintf(buffer, "Title: %s", title);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    sprintf(buffer, "Class: %s", classes[classIdx].className);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    sprintf(buffer, "Duration: %d minutes", duration);
-    drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-    
-    drawBoxMiddle();
-    drawBoxLine("Content encrypted with RSA", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxLine("Digital signature applied", BOX_WIDTH, COLOR_SUCCESS);
-    
-    drawBoxMiddle();
-    drawBoxLine("[!] Don't forget to distribute the key!", BOX_WIDTH, COLOR_INFO);
-    drawBoxBottom();
-    
-    examCount++;
-    saveExams();
-    saveClasses();
-    pauseScreen();
+    session.openTickets++;
+    OpenTicket* ticket = new OpenTicket();
+    ticket->sessionId = session.id;
+    ticket->student = session.user;
+    ticket->examId = examSym;
+    ticket->n = n;
+    ticket->e = e;
+    ticket->queuedMs = monotonicMs();
+    ticket->waitSentMs = 0;
+    ticket->waitPosition = 0;
+    waitingOpens.push_back(ticket);
 }
 
-void viewMyExams() {
-    clearScreen();
-    displayExamBanner();
-    displayHeader("MY EXAMS");
-    
-    bool found = false;
-    
-    const char* headers[] = {"ID", "Title", "Class", "Duration", "Key Sent", "Access"};
-    int colWidths[] = {10, 18, 12, 10, 9, 8};
-    int totalWidth = 71;
-    
-    bool headerPrinted = false;
-    
-    for (int i = 0; i < examCount; i++) {
-        if (strcmp(exams[i].teacherName, currentUser) == 0) {
-            if (!headerPrinted) {
-                cout << endl;
-                drawTableHeader(headers, 6, colWidths, totalWidth);
-                headerPrinted = true;
-            }
-            
-            found = true;
-            char durStr[15], accessStr[10];
-            sprintf(durStr, "%d min", exams[i].duration);
-            sprintf(accessStr, "%d", exams[i].approvedCount);
-            
-            const char* row[] = {
-                exams[i].id, 
-                exams[i].title, 
-                exams[i].assignedClassName,
-                durStr,
-                exams[i].keyDistributed ? "Yes" : "No",
-                accessStr
-            };
-            drawTableRow(row, 6, colWidths, totalWidth);
+// Called by the event loop after every poll. Delivers finished OPENs,
+// starts the waiting ones the limits allow and updates the rest on their
+// place in the queue. Tickets of sessions that are gone are dropped.
+void pumpAdmissions(vector<Session>& sessions) {
+    unordered_map<int, int> sessionRows;
+    for (int i = 0; i < (int)sessions.size(); i++) sessionRows[sessions[i].id] = i;
+    long long now = monotonicMs();
+
+    vector<OpenTicket*> finished;
+    mutexLock(admissionLock);
+    finished.swap(finishedOpens);
+    mutexUnlock(admissionLock);
+    for (int i = 0; i < (int)finished.size(); i++) {
+        opensRunning--;
+        recordLatency(openLatency, now - finished[i]->queuedMs);
+        unordered_map<int, int>::iterator row = sessionRows.find(finished[i]->sessionId);
+        if (row != sessionRows.end()) {
+            sessions[row->second].openTickets--;
+            sendLine(sessions[row->second], finished[i]->reply);
+        }
+        delete finished[i];
+    }
+
+    int runLimit = max(2, 2 * workerCount);
+    deque<OpenTicket*> stillWaiting;
+    for (int i = 0; i < (int)waitingOpens.size(); i++) {
+        OpenTicket* ticket = waitingOpens[i];
+        unordered_map<int, int>::iterator row = sessionRows.find(ticket->sessionId);
+        if (row == sessionRows.end()) {
+            delete ticket;
+            continue;
         }
+        if (opensRunning < runLimit && takeOpenToken(ticket->examId, now)) {
+            opensRunning++;
+            opensAdmitted++;
+            runAsync(runOpenTicket, ticket, PRIORITY_INTERACTIVE);
+            continue;
+        }
+        stillWaiting.push_back(ticket);
+        int position = (int)stillWaiting.size();
+        if (position != ticket->waitPosition && (ticket->waitPosition == 0 || now - ticket->waitSentMs >= WAIT_UPDATE_MS)) {
+            sendLine(sessions[row->second], "WAIT " + to_string(position));
+            ticket->waitPosition = position;
+            ticket->waitSentMs = now;
+        }
+    }
+    waitingOpens.swap(stillWaiting);
+}
+
+void serveStats(Session& session) {
+    char line[400];
+    sprintf(line, "OK waiting=%d running=%d admitted=%lld refused=%lld crack_memo_hits=%lld open_p50_ms=%lld open_p99_ms=%lld"
+            " submitted=%lld submit_batches=%lld submit_peak_per_s=%lld commit_p50_ms=%lld commit_p99_ms=%lld",
+            (int)waitingOpens.size(), opensRunning, opensAdmitted, opensRefused, crackMemoHits.load(),
+            latencyPercentile(openLatency, 50), latencyPercentile(openLatency, 99),
+            submissionsCommitted.load(), submitBatches.load(), peakSubmitRate.load(),
+            latencyPercentile(submitLatency, 50), latencyPercentile(submitLatency, 99));
+    sendLine(session, line);
+}
+
+void serveDraft(Session& session, string_view args) {
+    string examId(nextWord(args));
+    while (!args.empty() && args[0] == ' ') args.remove_prefix(1);
+    char text[5000];
+    unescapeLine(args, text, sizeof(text) - 1);
+    strcat(text, "\n");
+    switch (appendAnswer(session.user, lookupSymbol(examId.c_str()), text)) {
+        case DRAFT_NO_ATTEMPT: sendLine(session, "ERR no running attempt"); return;
+        case DRAFT_TOO_LONG: sendLine(session, "ERR answer longer than " + to_string(MAX_ANSWER)); return;
+        case DRAFT_ADDED: break;
     }
-    
-    if (found) {
-        drawTableBottom(6, colWidths, totalWidth);
-    } else {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("No exams created yet", BOX_WIDTH, COLOR_INFO);
-        drawBoxBottom();
+    sendLine(session, "OK");
+}
+
+void serveMail(Session& session, string_view args) {
+    string to(nextWord(args));
+    while (!args.empty() && args[0] == ' ') args.remove_prefix(1);
+    char text[1000];
+    unescapeLine(args, text, sizeof(text));
+    Symbol messageId;
+    switch (sendMessage(session.user, to.c_str(), text, messageId)) {
+        case SEND_NO_USER: sendLine(session, "ERR recipient not found"); return;
+        case SEND_EMPTY: sendLine(session, "ERR empty message"); return;
+        case SEND_TOO_LONG: sendLine(session, "ERR message longer than " + to_string(MAX_MESSAGE_LENGTH)); return;
+        case SEND_OK: break;
     }
-    
-    pauseScreen();
+    sendLine(session, string("OK ") + symbolName(messageId));
 }
 
+void serveInbox(Session& session, string_view args) {
+    string page(nextWord(args));
+    vector<InboxEntry> entries;
+    inboxPage(session.user, page.empty() ? 0 : max(0, atoi(page.c_str())), entries);
+    vector<string> lines;
+    for (int i = 0; i < (int)entries.size(); i++) {
+        lines.push_back(string(symbolName(entries[i].id)) + "," + symbolName(entries[i].from) +
+                        (entries[i].isRead ? ",READ" : ",NEW") + (entries[i].intact ? ",OK," : ",TAMPERED,") +
+                        escapeLine(entries[i].text.c_str()));
+    }
+    sendListing(session, lines);
+}
 
-void distributeExamKey() {
-    clearScreen();
-    displayRSABanner();
-    displayHeader("DISTRIBUTE EXAM KEY");
-    
-    if (keyDistCount >= MAX_KEYS) {
-        drawBoxTop();
-        drawBoxLine("[!] Maximum key distribution limit!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
+void serveRead(Session& session, string_view args) {
+    string messageId(nextWord(args));
+    if (!markMessageRead(session.user, lookupSymbol(messageId.c_str()))) {
+        sendLine(session, "ERR no such message");
         return;
     }
-    
-    displaySectionHeader("YOUR EXAMS");
-    
-    bool hasExams = false;
-    const char* headers[] = {"Exam ID", "Title", "Key Status"};
-    int colWidths[] = {12, 25, 12};
-    int totalWidth = 53;
-    
-    bool headerPrinted = false;
-    
-    for (int i = 0; i < examCount; i++) {
-        if (strcmp(exams[i].teacherName, currentUser) == 0 && exams[i].isActive) {
-            if (!headerPrinted) {
-                drawTableHeader(headers, 3, colWidths, totalWidth);
-                headerPrinted = true;
-            }
-            hasExams = true;
-            const char* row[] = {
-                exams[i].id,
-                exams[i].title,
-                exams[i].keyDistributed ? "Sent" : "Pending"
-            };
-            drawTableRow(row, 3, colWidths, totalWidth);
-        }
+    sendLine(session, "OK " + to_string(unreadMessages(session.user)));
+}
+
+void serveDelete(Session& session, string_view args) {
+    string messageId(nextWord(args));
+    if (!deleteMessage(session.user, lookupSymbol(messageId.c_str()))) {
+        sendLine(session, "ERR no such message");
+        return;
     }
-    
-    if (hasExams) {
-        drawTableBottom(3, colWidths, totalWidth);
-    } else {
-        drawBoxTop();
-        drawBoxLine("[!] No exams to distribute keys for", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
+    sendLine(session, "OK " + to_string(unreadMessages(session.user)));
+}
+
+// The n and e words are still read but the key comes from the attempt, so
+// SUBMIT never cracks anything on the event loop.
+void serveSubmit(Session& session, string_view args) {
+    Symbol examSym = lookupSymbol(string(nextWord(args)).c_str());
+    nextWord(args);
+    nextWord(args);
+    while (!args.empty() && args[0] == ' ') args.remove_prefix(1);
+    char answer[5000];
+    unescapeLine(args, answer, sizeof(answer));
+    switch (appendAnswer(session.user, examSym, answer)) {
+        case DRAFT_NO_ATTEMPT: sendLine(session, "ERR no running attempt"); return;
+        case DRAFT_TOO_LONG: sendLine(session, "ERR answer longer than " + to_string(MAX_ANSWER)); return;
+        case DRAFT_ADDED: break;
+    }
+    Attempt finished;
+    if (!finishAttempt(session.user, examSym, finished)) {
+        sendLine(session, "ERR no running attempt");
         return;
     }
-    
-    char examId[20];
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Enter Exam ID: ";
-    resetColor();
-    cin.getline(examId, 20);
-    
-    int examIdx = findExam(examId);
-    if (examIdx == -1 || strcmp(exams[examIdx].teacherName, currentUser) != 0) {
-        drawBoxTop();
-        drawBoxLine("[!] Exam not found!", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
+    Submission* s = newSubmission(session.user, examSym, finished.answer.c_str(), finished.e, finished.n, finished.d);
+    s->notify = NOTIFY_SESSION;
+    s->sessionId = session.id;
+    session.submitsPending++;
+    submitsOutstanding++;
+    queueSubmission(s);
+}
+
+// Replies to SUBMITs whose batch has been committed.
+void pumpSubmissions(vector<Session>& sessions) {
+    vector<Submission*> finished;
+    mutexLock(ingestLock);
+    finished.swap(finishedSubmits);
+    mutexUnlock(ingestLock);
+    if (finished.empty()) return;
+    unordered_map<int, int> sessionRows;
+    for (int i = 0; i < (int)sessions.size(); i++) sessionRows[sessions[i].id] = i;
+    for (int i = 0; i < (int)finished.size(); i++) {
+        Submission* s = finished[i];
+        submitsOutstanding--;
+        unordered_map<int, int>::iterator row = sessionRows.find(s->sessionId);
+        if (row != sessionRows.end()) {
+            sessions[row->second].submitsPending--;
+            sendLine(sessions[row->second], s->stored ? string("OK ") + symbolName(s->record.id) : string("ERR exam not found"));
+        }
+        delete s;
+    }
+}
+
+void serveSubmissions(Session& session, string_view args) {
+    TableGuard guard(TABLE_EXAMS | TABLE_ASSIGNMENTS, 0);
+    string examId(nextWord(args));
+    int eIdx = findExam(examId.c_str());
+    if (eIdx == -1 || exams[eIdx].teacherName != session.user) {
+        sendLine(session, "ERR access denied");
         return;
     }
-    
-    cout << endl;
-    drawBoxTop(40);
-    drawBoxLine("Distribution Options", 40, COLOR_HEADER);
-    drawBoxMiddle(40);
-    drawBoxLineLeft("1. Send to ENTIRE CLASS", 40, COLOR_INFO);
-    drawBoxLineLeft("2. Send to INDIVIDUAL", 40, COLOR_INFO);
-    drawBoxLineLeft("0. Cancel", 40, COLOR_DEFAULT);
-    drawBoxBottom(40);
-    
-    cout << endl;
-    setColor(COLOR_INFO);
-    cout << "                                                    Choice: ";
-    resetColor();
-    
-    int choice;
-    cin >> choice;
-    cin.ignore();
-    
-    if (choice == 0) {
-        pauseScreen();
+    if (!hasExamKey(examPayloads[eIdx])) {
+        sendLine(session, "ERR exam has no key");
         return;
     }
-    
-    int userIdx = findUser(currentUser);
-    
-    if (choice == 1) {
-        generateId(keyDist[keyDistCount].id, "KEY");
-        strncpy(keyDist[keyDistCount].examId, exams[examIdx].id, 19);
-        keyDist[keyDistCount].examId[19] = '\0';
-        strncpy(keyDist[keyDistCount].examTitle, exams[examIdx].title, 99);
-        keyDist[keyDistCount].examTitle[99] = '\0';
-        strncpy(keyDist[keyDistCount].classId, exams[examIdx].assignedClassId, 19);
-        keyDist[keyDistCount].classId[19] = '\0';
-        strncpy(keyDist[keyDistCount].className, exams[examIdx].assignedClassName, 99);
-        keyDist[keyDistCount].className[99] = '\0';
-        strncpy(keyDist[keyDistCount].fromTeacher, currentUser, 49);
-        keyDist[keyDistCount].fromTeacher[49] = '\0';
-        strncpy(keyDist[keyDistCount].toStudent, "CLASS", 49);
-        
-        // --- SECURE KEYS ---
-        keyDist[keyDistCount].publicKeyE = exams[examIdx].exam_e;
-        keyDist[keyDistCount].publicKeyN = exams[examIdx].exam_n;
-        keyDist[keyDistCount].p = exams[examIdx].exam_p;
-        keyDist[keyDistCount].q = exams[examIdx].exam_q;
-        
-        // === THIS WAS THE MISSING LINE FIX ===
-        keyDist[keyDistCount].isClassWide = true; 
-        keyDist[keyDistCount].isRead = false;
-        // =====================================
-        
-        int classIdx = findClass(exams[examIdx].assignedClassId);
-        if (classIdx != -1) {
-            for (int j = 0; j < classes[classIdx].studentCount; j++) {
-                if (exams[examIdx].approvedCount < 50) {
-                    strncpy(exams[examIdx].approvedStudents[exams[examIdx].approvedCount], 
-                            classes[classIdx].enrolledStudents[j], 49);
-                    exams[examIdx].approvedStudents[exams[examIdx].approvedCount][49] = '\0';
-                    exams[examIdx].approvedCount++;
-                }
-            }
-        }
-        
-        exams[examIdx].keyDistributed = true;
-        
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("KEY SENT TO ENTIRE CLASS!", BOX_WIDTH, COLOR_SUCCESS);
-        drawBoxMiddle();
-        
-        char buffer[60];
-        sprintf(buffer, "Exam: %s", exams[examIdx].title);
-        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-        sprintf(buffer, "Class: %s", exams[examIdx].assignedClassName);
-        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-        
-        drawBoxMiddle();
-        drawBoxLine("PUBLIC KEY DISTRIBUTED", BOX_WIDTH, COLOR_HEADER);
-        sprintf(buffer, "e = %lld", keyDist[keyDistCount].publicKeyE);
-        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
-        sprintf(buffer, "n = %lld", keyDist[keyDistCount].publicKeyN);
-        drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
-        
-        drawBoxBottom();
-        keyDistCount++;
-        
-    } else if (choice == 2) {
-        char studentName[50];
-        setColor(COLOR_INFO);
-        cout << "\n                                                    Enter student username: ";
-        resetColor();
-        cin.getline(studentName, 50);
-        
-        if (!isStudentInClass(studentName, exams[examIdx].assignedClassId)) {
-            drawBoxTop();
-            drawBoxLine("[!] Student not in this class!", BOX_WIDTH, COLOR_ERROR);
-            drawBoxBottom();
-            pauseScreen();
-            return;
-        }
-        
-        generateId(keyDist[keyDistCount].id, "KEY");
-        strncpy(keyDist[keyDistCount].examId, exams[examIdx].id, 19);
-        keyDist[keyDistCount].examId[19] = '\0';
-        strncpy(keyDist[keyDistCount].examTitle, exams[examIdx].title, 99);
-        keyDist[keyDistCount].examTitle[99] = '\0';
-        strncpy(keyDist[keyDistCount].classId, exams[examIdx].assignedClassId, 19);
-        keyDist[keyDistCount].classId[19] = '\0';
-        strncpy(keyDist[keyDistCount].className, exams[examIdx].assignedClassName, 99);
-        keyDist[keyDistCount].className[99] = '\0';
-        strncpy(keyDist[keyDistCount].fromTeacher, currentUser, 49);
-        keyDist[keyDistCount].fromTeacher[49] = '\0';
-        strncpy(keyDist[keyDistCount].toStudent, studentName, 49);
-        keyDist[keyDistCount].toStudent[49] = '\0';
-        
-        keyDist[keyDistCount].publicKeyE = exams[examIdx].exam_e;
-        keyDist[keyDistCount].publicKeyN = exams[examIdx].exam_n;
-        keyDist[keyDistCount].p = exams[examIdx].exam_p;
-        keyDist[keyDistCount].q = exams[examIdx].exam_q;
-        
-        keyDist[keyDistCount].isClassWide = false;
-        keyDist[keyDistCount].isRead = false;
-        
-        if (exams[examIdx].approvedCount < 50) {
-            strncpy(exams[examIdx].approvedStudents[exams[examIdx].approvedCount], studentName, 49);
-            exams[examIdx].approvedStudents[exams[examIdx].approvedCount][49] = '\0';
-            exams[examIdx].approvedCount++;
+    vector<int> subRows;
+    if (exams[eIdx].id < (int)examSubmissions.size()) {
+        const vector<Symbol>& subIds = examSubmissions[exams[eIdx].id];
+        for (int j = 0; j < (int)subIds.size(); j++) {
+            int i = findAssignment(subIds[j]);
+            if (i != -1) subRows.push_back(i);
         }
-        
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("KEY SENT TO STUDENT!", BOX_WIDTH, COLOR_SUCCESS);
-        drawBoxMiddle();
-        
-        char buffer[60];
-        sprintf(buffer, "Student: %s", studentName);
-        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-        sprintf(buffer, "Exam: %s", exams[examIdx].title);
-        drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-        
-        drawBoxBottom();
-        keyDistCount++;
     }
-    
-    saveKeyDistributions();
-    saveExams();
-    pauseScreen();
+    vector<DecryptJob> answers(subRows.size());
+    for (int j = 0; j < (int)subRows.size(); j++) {
+        answers[j].ciphertext = assignmentPayloads[subRows[j]].encryptedSubmission;
+        answers[j].d = examPayloads[eIdx].exam_d;
+        answers[j].n = examPayloads[eIdx].exam_n;
+    }
+    decryptAll(answers);
+    vector<string> lines;
+    for (int j = 0; j < (int)subRows.size(); j++) {
+        int i = subRows[j];
+        lines.push_back(string(symbolName(assignments[i].id)) + "," + symbolName(assignments[i].studentName) + "," + escapeLine(answers[j].plaintext));
+    }
+    sendListing(session, lines);
 }
-void viewReceivedKeys() {
-    clearScreen();
-    displayRSABanner();
-    displayHeader("RECEIVED EXAM KEYS");
-    
-    bool found = false;
-    
-    for (int i = 0; i < keyDistCount; i++) {
-        bool forMe = (strcmp(keyDist[i].toStudent, currentUser) == 0) ||
-                     (keyDist[i].isClassWide && isStudentInClass(currentUser, keyDist[i].classId));
-        
-        if (forMe) {
-            found = true;
-            cout << endl;
-            drawBoxTop();
-            
-            if (keyDist[i].isRead) {
-                drawBoxLine("[READ] Key Distribution", BOX_WIDTH, COLOR_DEFAULT);
-            } else {
-                drawBoxLine("[NEW] Key Distribution", BOX_WIDTH, COLOR_SUCCESS);
-            }
-            
-            drawBoxMiddle();
-            
-            char buffer[60];
-            sprintf(buffer, "Exam ID: %s", keyDist[i].examId);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_TITLE); // Highlighted in Magenta (Color 13)
-            sprintf(buffer, "From: %s", keyDist[i].fromTeacher);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_INFO);
-            sprintf(buffer, "Exam: %s", keyDist[i].examTitle);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            sprintf(buffer, "Class: %s", keyDist[i].className);
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            sprintf(buffer, "Type: %s", keyDist[i].isClassWide ? "Class-wide" : "Individual");
-            drawBoxLineLeft(buffer, BOX_WIDTH, COLOR_DEFAULT);
-            
-            drawBoxMiddle();
-            drawBoxLine("PUBLIC KEY FOR DECRYPTION", BOX_WIDTH, COLOR_HEADER);
-            drawBoxMiddle();
-            
-            sprintf(buffer, "e = %lld", keyDist[i].publicKeyE);
-            drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
-            sprintf(buffer, "n = %lld", keyDist[i].publicKeyN);
-            drawBoxLine(buffer, BOX_WIDTH, COLOR_SUCCESS);
-            
-            drawBoxBottom();
-            
-            keyDist[i].isRead = true;
-        }
+
+void handleRequest(Session& session, string_view line) {
+    string_view args = line;
+    string command(nextWord(args));
+    for (int i = 0; i < (int)command.size(); i++) {
+        if (command[i] >= 'a' && command[i] <= 'z') command[i] -= 32;
     }
-    
-    if (found) {
-        saveKeyDistributions();
+    if (command.empty()) return;
+    if (command == "QUIT") {
+        sendLine(session, "OK bye");
+        session.closing = true;
+        return;
+    }
+    if (command == "HELP") {
+        sendLine(session, "OK LOGIN LOGOUT QUIT CLASSES EXAMS KEYS JOIN OPEN DRAFT SUBMIT SUBMISSIONS STATS MAIL INBOX READ DELETE");
+        return;
+    }
+    if (command == "LOGIN") {
+        serveLogin(session, args);
+        return;
+    }
+    if (session.user == NO_SYMBOL) {
+        sendLine(session, "ERR not logged in");
+        return;
+    }
+    bool teacher = strcmp(session.role, "teacher") == 0;
+    if (command == "LOGOUT") {
+        session.user = NO_SYMBOL;
+        session.role[0] = '\0';
+        sendLine(session, "OK");
+    } else if (command == "CLASSES") {
+        serveClasses(session, teacher);
+    } else if (command == "EXAMS") {
+        serveExams(session, teacher);
+    } else if (command == "STATS") {
+        serveStats(session);
+    } else if (command == "MAIL") {
+        serveMail(session, args);
+    } else if (command == "INBOX") {
+        serveInbox(session, args);
+    } else if (command == "READ") {
+        serveRead(session, args);
+    } else if (command == "DELETE") {
+        serveDelete(session, args);
+    } else if (command == "SUBMISSIONS" && teacher) {
+        serveSubmissions(session, args);
+    } else if (command == "KEYS" && !teacher) {
+        serveKeys(session);
+    } else if (command == "JOIN" && !teacher) {
+        serveJoin(session, args);
+    } else if (command == "OPEN" && !teacher) {
+        serveOpen(session, args);
+    } else if (command == "DRAFT" && !teacher) {
+        serveDraft(session, args);
+    } else if (command == "SUBMIT" && !teacher) {
+        serveSubmit(session, args);
     } else {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("No exam keys received yet", BOX_WIDTH, COLOR_INFO);
-        drawBoxBottom();
+        sendLine(session, "ERR unknown command for this role");
     }
-    
-    pauseScreen();
 }
-void crackPrivateKey(long long n, long long e, long long& d_out, long long& p_out, long long& q_out) {
-    p_out = 0;
-    q_out = 0;
-    
-    // 1. FACTORIZE N (Brute force factor finding)
-    // We look for a number 'i' that divides 'n' cleanly.
-    for (long long i = 2; i * i <= n; i++) {
-        if (n % i == 0) {
-            p_out = i;
-            q_out = n / i;
+
+// A client may send its requests and then half-close, so the lines that
+// came with the EOF are still answered and the session closes once the
+// replies are out. Input is not polled after EOF; a hangup then means the
+// peer is gone entirely.
+void readSession(Session& session) {
+    if (session.readDone) {
+        session.hungUp = true;
+        return;
+    }
+    char buffer[4096];
+    while (true) {
+        int got = recv(session.sock, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            session.input.append(buffer, got);
+            continue;
+        }
+        if (got == 0) {
+            session.readDone = true;
             break;
         }
+        if (socketWouldBlock()) break;
+        session.hungUp = true;
+        return;
     }
+    size_t start = 0, end;
+    while (!session.closing && (end = session.input.find('\n', start)) != string::npos) {
+        string_view line(session.input.data() + start, end - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        handleRequest(session, line);
+        start = end + 1;
+    }
+    session.input.erase(0, start);
+    if ((int)session.input.size() > MAX_REQUEST_LINE) {
+        sendLine(session, "ERR request too long");
+        session.closing = true;
+    }
+    if (session.readDone) session.closing = true;
+}
 
-    if (p_out == 0) return; // Failed to crack
+void writeSession(Session& session) {
+    while (!session.output.empty()) {
+        int sent = send(session.sock, session.output.data(), (int)session.output.size(), SEND_FLAGS);
+        if (sent > 0) {
+            session.output.erase(0, sent);
+            continue;
+        }
+        if (sent < 0 && socketWouldBlock()) return;
+        session.hungUp = true;
+        return;
+    }
+}
 
-    // 2. CALCULATE PHI (Euler's Totient)
-    long long phi = (p_out - 1) * (q_out - 1);
+int nextSessionId = 0;
 
-    // 3. CALCULATE PRIVATE KEY (d)
-    // d is the modular multiplicative inverse of e mod phi
-    d_out = modInverse(e, phi);
+void acceptSessions(SocketHandle listener, vector<Session>& sessions) {
+    while (true) {
+        SocketHandle sock = accept(listener, NULL, NULL);
+        if (sock == INVALID_SOCKET) return;
+        if (!setNonBlocking(sock)) {
+            closeSocket(sock);
+            continue;
+        }
+        Session session;
+        session.id = ++nextSessionId;
+        session.sock = sock;
+        session.user = NO_SYMBOL;
+        session.role[0] = '\0';
+        session.closing = false;
+        session.hungUp = false;
+        session.readDone = false;
+        session.openTickets = 0;
+        session.submitsPending = 0;
+        sessions.push_back(session);
+    }
 }
-void attemptExam() {
-    clearScreen();
-    displayHeader("ATTEMPT EXAM");
-
-    // --- STEP 1: SELECT EXAM ---
-    char examId[20];
-    setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID to attempt: "; resetColor();
-    cin.getline(examId, 20);
 
-    int idx = findExam(examId);
-    if (idx == -1) {
-        drawBoxTop();
-        drawBoxLine("[!] Exam not found.", BOX_WIDTH, COLOR_ERROR);
-        drawBoxBottom();
-        pauseScreen();
-        return;
+int runServer(int port) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return 1;
+#endif
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET) return 1;
+    int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)) {
+        cout << "Could not listen on port " << port << endl;
+        closeSocket(listener);
+        return 1;
     }
+    cout << "Secure Exam server listening on 127.0.0.1:" << port << endl;
+
+    vector<Session> sessions;
+    vector<PollEntry> fds;
+    while (true) {
+        fds.resize(sessions.size() + 1);
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        for (int i = 0; i < (int)sessions.size(); i++) {
+            fds[i + 1].fd = sessions[i].sock;
+            short wanted = sessions[i].readDone ? 0 : POLLIN;
+            fds[i + 1].events = sessions[i].output.empty() ? wanted : (wanted | POLLOUT);
+            fds[i + 1].revents = 0;
+        }
+        bool admitting = opensRunning > 0 || !waitingOpens.empty() || submitsOutstanding > 0;
+        int ready = pollSockets(fds.data(), fds.size(), admitting ? ADMISSION_POLL_MS : SERVER_IDLE_MS);
+        if (ready < 0) {
+#ifndef _WIN32
+            if (errno == EINTR) continue;
+#endif
+            break;
+        }
+        if (ready == 0) {
+            pumpAdmissions(sessions);
+            pumpSubmissions(sessions);
+            // Sessions hold Symbols, never rows, so tables may move between requests.
+            if (!admitting) compactTables(false);
+            continue;
+        }
 
-    // --- STEP 2: INPUT PUBLIC KEY ---
-    long long inputN, inputE;
-    
-    cout << endl;
-    drawBoxTop(60);
-    drawBoxLine("KEY CRACKING MODULE", 60, COLOR_HEADER);
-    drawBoxMiddle(60);
-    drawBoxLineLeft("Enter the Public Key (N, E) to break encryption.", 60, COLOR_DEFAULT);
-    drawBoxBottom(60);
-    cout << endl;
+        for (int i = 0; i < (int)sessions.size(); i++) {
+            short events = fds[i + 1].revents;
+            if (events & (POLLIN | POLLHUP | POLLERR)) readSession(sessions[i]);
+            if (!sessions[i].hungUp && !sessions[i].output.empty()) writeSession(sessions[i]);
+        }
+        if (fds[0].revents & POLLIN) acceptSessions(listener, sessions);
+        pumpAdmissions(sessions);
+        pumpSubmissions(sessions);
+
+        int kept = 0;
+        for (int i = 0; i < (int)sessions.size(); i++) {
+            const Session& s = sessions[i];
+            if (s.hungUp || (s.closing && s.output.empty() && s.openTickets == 0 && s.submitsPending == 0)) {
+                closeSocket(sessions[i].sock);
+                continue;
+            }
+            if (kept != i) sessions[kept] = sessions[i];
+            kept++;
+        }
+        sessions.resize(kept);
+    }
+    closeSocket(listener);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 1;
+}
 
-    setColor(COLOR_INFO); cout << "                                                    Enter Modulus (N): "; resetColor();
-    if (!(cin >> inputN)) { cin.clear(); cin.ignore(); return; }
-    
-    setColor(COLOR_INFO); cout << "                                                    Enter Exponent (E): "; resetColor();
-    if (!(cin >> inputE)) { cin.clear(); cin.ignore(); return; }
-    cin.ignore(); 
+//  BENCHMARKS
+// "--bench-<name> [args]" runs a benchmark instead of the menu and prints
+// its results. Benchmarks work in the scratch directory bench/ and build
+// their own synthetic data there, so the real data files are never loaded
+// or written; the scratch files are removed afterwards.
+//   --bench-submit [producers] [submissions]
+//   --bench-locks [readers] [seconds per phase]
+//   --bench-csv [megabytes]
+//   --bench-index [users] [exams]
+//   --bench-scan [exams]
+const char* BENCH_DIR = "bench";
+const int BENCH_ANSWER_LENGTH = 300;
+
+// One producer thread of benchSubmit(). It submits every stride-th answer
+// from first on, each as a different student, and waits for each commit.
+struct SubmitProducer {
+    Symbol examId;
+    long long e, n, d;
+    int first, stride, total;
+    ThreadHandle thread;
+};
 
-    // --- STEP 3: CRACKING ANIMATION ---
-    cout << endl;
-    setColor(COLOR_TITLE); cout << "                                                    INITIATING FACTORIZATION ATTACK..." << endl; Sleep(500);
-    setColor(COLOR_DEFAULT); cout << "                                                    Targeting Modulus N = " << inputN << endl; Sleep(300);
-    
-    long long calcD, calcP, calcQ;
-    crackPrivateKey(inputN, inputE, calcD, calcP, calcQ);
+THREAD_MAIN(submitProducerMain) {
+    SubmitProducer* producer = (SubmitProducer*)arg;
+    string answer(BENCH_ANSWER_LENGTH, 'x');
+    char student[20];
+    for (int i = producer->first; i < producer->total; i += producer->stride) {
+        sprintf(student, "bench%d", i);
+        submitAnswer(intern(student), producer->examId, answer.c_str(), producer->e, producer->n, producer->d);
+    }
+    return 0;
+}
 
-    if (calcP == 0) {
-        setColor(COLOR_ERROR); cout << "                                                    Attack Failed. N is prime or too large." << endl;
-        pauseScreen(); return;
+// Sustained submissions per second through the ingestion pipeline, and the
+// commit latency (queued to on disk) it recorded.
+int benchSubmit(int producers, int total) {
+    if (producers <= 0) producers = 8;
+    if (total <= 0) total = 20000;
+    Symbol teacher = users[addUser("benchteacher", "bench", "teacher")].username;
+    int classIdx = addClass("Bench", teacher);
+    int examIdx = addExam(classIdx, "Bench", "Benchmark exam", 60, 0, 0, teacher);
+    if (examIdx == -1) return 1;
+
+    vector<SubmitProducer> threads(producers);
+    long long batchesBefore = submitBatches;
+    long long started = monotonicMs();
+    for (int i = 0; i < producers; i++) {
+        SubmitProducer& producer = threads[i];
+        producer.examId = exams[examIdx].id;
+        producer.e = examPayloads[examIdx].exam_e;
+        producer.n = examPayloads[examIdx].exam_n;
+        producer.d = examPayloads[examIdx].exam_d;
+        producer.first = i;
+        producer.stride = producers;
+        producer.total = total;
+        startThread(producer.thread, submitProducerMain, &producer);
     }
+    for (int i = 0; i < producers; i++) joinThread(threads[i].thread);
+    long long elapsed = max(1LL, monotonicMs() - started);
 
-    setColor(COLOR_SUCCESS); cout << "                                                    Factors Found: P=" << calcP << ", Q=" << calcQ << endl; Sleep(300);
-    setColor(COLOR_INFO);    cout << "                                                    Calculated Phi(n) = " << (calcP-1)*(calcQ-1) << endl; Sleep(300);
-    setColor(COLOR_HEADER);  cout << "                                                    PRIVATE KEY (d) RECOVERED: " << calcD << endl; Sleep(800);
+    char line[200];
+    sprintf(line, "submit: %d answers from %d producers in %lld ms, %lld/s, %lld batches, commit p50 %lld ms, p99 %lld ms",
+            total, producers, elapsed, total * 1000LL / elapsed, submitBatches - batchesBefore,
+            latencyPercentile(submitLatency, 50), latencyPercentile(submitLatency, 99));
+    cout << line << endl;
+    return 0;
+}
 
-    // --- STEP 4: DECRYPT EXAM ---
-    char decryptedContent[5000];
-    // Use the CALCULATED private key (calcD) to unlock the exam
-    decryptMessage(exams[idx].encryptedContent, decryptedContent, calcD, inputN);
+// Table lock contention. Readers run the student dashboard read (visible
+// keys, their read marks and the enrolled classes) under shared locks while
+// one writer marks keys read under the exclusive TABLE_KEYDIST lock, first
+// with one reader and then with all of them, so the read rate shows how
+// shared locking scales across cores next to a writer.
+const int LOCK_BENCH_CLASSES = 20;
+const int LOCK_BENCH_STUDENTS = 100;   // per class
+
+struct LockBenchThread {
+    bool writer;
+    long long ops;
+    long long visible;   // keys and classes seen, so the reads are not idle
+    ThreadHandle thread;
+};
 
-    // Basic validation: If decryption failed, it usually looks like garbage text
-    if (strlen(decryptedContent) == 0) {
-        setColor(COLOR_ERROR); cout << "\n                                                    Decryption yielded empty result." << endl;
-        pauseScreen(); return;
+vector<Symbol> lockBenchStudents;
+atomic<bool> lockBenchStop(false);
+
+THREAD_MAIN(lockBenchMain) {
+    LockBenchThread* self = (LockBenchThread*)arg;
+    vector<int> rows;
+    while (!lockBenchStop) {
+        Symbol student = lockBenchStudents[randomNext() % lockBenchStudents.size()];
+        {
+            TableGuard guard(TABLE_CLASSES | TABLE_KEYDIST, 0);
+            visibleKeys(student, rows);
+            for (int r = 0; r < (int)rows.size(); r++) self->visible += setContains(keyDist[rows[r]].readers, student);
+            const vector<Symbol>& enrolled = studentViews[student].classes;
+            for (int j = 0; j < (int)enrolled.size(); j++) self->visible += findClass(enrolled[j]) != -1;
+        }
+        if (self->writer) markKeysRead(student, rows);
+        self->ops++;
     }
+    return 0;
+}
 
-    clearScreen();
-    displayHeader(exams[idx].title);
-    
-    drawBoxTop();
-    drawBoxLine("EXAM UNLOCKED", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxMiddle();
-    setColor(COLOR_DEFAULT);
-    cout << "  " << decryptedContent << endl;
-    cout << endl;
-    drawBoxBottom();
+long long lockBenchWaits(long long& acquires) {
+    acquires = lockAcquires[1] + lockAcquires[4];   // Classes, Key dists
+    return lockWaits[1] + lockWaits[4];
+}
 
-    // --- STEP 5: SUBMIT ANSWER ---
-    cout << "\n                                                    Type your answer below (Type 'SUBMIT' on a new line to finish):\n";
-    cout << "                                                    ------------------------------------------------------------\n";
-    setColor(COLOR_SUCCESS);
-    
-    char answer[5000]; answer[0] = '\0';
-    char line[1000];
-    while (cin.getline(line, 1000)) {
-        if (strcmp(line, "SUBMIT") == 0) break;
-        strcat(answer, line);
-        strcat(answer, "\n");
+// Runs readers plus one writer for seconds and prints the rates. Returns
+// reads per second.
+long long lockBenchPhase(int readers, int seconds) {
+    vector<LockBenchThread> threads(readers + 1);
+    long long acquiresBefore, waitsBefore = lockBenchWaits(acquiresBefore);
+    lockBenchStop = false;
+    for (int i = 0; i <= readers; i++) {
+        threads[i].writer = i == readers;
+        threads[i].ops = 0;
+        threads[i].visible = 0;
+        startThread(threads[i].thread, lockBenchMain, &threads[i]);
     }
-    resetColor();
+    Sleep(seconds * 1000);
+    lockBenchStop = true;
+    long long reads = 0;
+    for (int i = 0; i <= readers; i++) {
+        joinThread(threads[i].thread);
+        if (i < readers) reads += threads[i].ops;
+    }
+    long long acquires, waits = lockBenchWaits(acquires) - waitsBefore;
+    acquires -= acquiresBefore;
 
-    // --- STEP 6: ENCRYPT & SAVE SUBMISSION ---
-    // We encrypt the answer with the Teacher's Public Key (inputE, inputN)
-    // so only the teacher can read it.
-    
-    generateId(assignments[assignmentCount].id, "SUB");
-    strncpy(assignments[assignmentCount].studentName, currentUser, 49);
-    strncpy(assignments[assignmentCount].courseName, exams[idx].id, 99);
-    assignments[assignmentCount].isGraded = false;
-    
-    encryptMessage(answer, assignments[assignmentCount].encryptedSubmission, inputE, inputN);
-    
-    // Digital Signature (Student signs with their calculated private key just to prove it's them)
-    long long sig = createSignature(answer, calcD, inputN);
-    strncpy(assignments[assignmentCount].signature.signedBy, currentUser, 49);
-    assignments[assignmentCount].signature.signatureHash = sig;
-    assignments[assignmentCount].signature.isVerified = true;
+    char line[200];
+    sprintf(line, "locks: %d reader%s + 1 writer, %lld reads/s, %lld writes/s, %.1f%% of lock acquires waited",
+            readers, readers == 1 ? "" : "s", reads / seconds, threads[readers].ops / seconds, acquires ? waits * 100.0 / acquires : 0.0);
+    cout << line << endl;
+    return reads / seconds;
+}
 
-    assignmentCount++;
-    saveAssignments();
+int benchLocks(int readers, int seconds) {
+    if (readers <= 0) readers = max(2, min(cpuCount(), MAX_WORKERS));
+    if (seconds <= 0) seconds = 2;
+    Symbol teacher = users[addUser("benchteacher", "bench", "teacher")].username;
+    char name[40];
+    for (int c = 0; c < LOCK_BENCH_CLASSES; c++) {
+        sprintf(name, "Bench %d", c);
+        int classIdx = addClass(name, teacher);
+        string roster;
+        for (int i = 0; i < LOCK_BENCH_STUDENTS; i++) {
+            sprintf(name, "lock%d_%d", c, i);
+            roster += string(name) + ",bench\n";
+            lockBenchStudents.push_back(intern(name));
+        }
+        RosterReport report;
+        importRoster(classes[classIdx].classId, roster, report);
+        int examIdx = addExam(classIdx, "Bench", "Benchmark exam", 60, 0, 0, teacher);
+        if (examIdx == -1) return 1;
+        int sealed;
+        addKeyDist(examIdx, teacher, NO_SYMBOL, sealed);
+    }
+    flushPersistence();
 
-    cout << endl;
-    drawBoxTop();
-    drawBoxLine("SUBMISSION ENCRYPTED & SENT", BOX_WIDTH, COLOR_SUCCESS);
-    drawBoxBottom();
-    
-    pauseScreen();
+    long long single = lockBenchPhase(1, seconds);
+    long long many = lockBenchPhase(readers, seconds);
+    char line[100];
+    sprintf(line, "locks: reads scale x%.2f from 1 to %d readers", single ? (double)many / single : 0.0, readers);
+    cout << line << endl;
+    return 0;
 }
-void viewSubmissions() {
-    clearScreen();
-    displayHeader("STUDENT SUBMISSIONS");
-  
-    bool found = false;
-    
-    const char* headers[] = {"ID", "Title", "Class", "Duration", "Key Sent", "Access"};
-    int colWidths[] = {10, 18, 12, 10, 9, 8};
-    int totalWidth = 71;
-    
-    bool headerPrinted = false;
-    
-    for (int i = 0; i < examCount; i++) {
-        if (strcmp(exams[i].teacherName, currentUser) == 0) {
-            if (!headerPrinted) {
-                cout << endl;
-                drawTableHeader(headers, 6, colWidths, totalWidth);
-                headerPrinted = true;
-            }
-            
-            found = true;
-            char durStr[15], accessStr[10];
-            sprintf(durStr, "%d min", exams[i].duration);
-            sprintf(accessStr, "%d", exams[i].approvedCount);
-            
-            const char* row[] = {
-                exams[i].id, 
-                exams[i].title, 
-                exams[i].assignedClassName,
-                durStr,
-                exams[i].keyDistributed ? "Yes" : "No",
-                accessStr
-            };
-            drawTableRow(row, 6, colWidths, totalWidth);
+
+// CSV tokenizer throughput. Writes a synthetic file shaped like the data
+// files (short user rows and long ciphertext rows), reads it back with
+// csvReadFile() and splits every line into fields with csvNextLine() and
+// csvNextField() until at least CSV_BENCH_MIN_MS have passed.
+const char* CSV_BENCH_FILE = "bench.csv";
+const int CSV_BENCH_MIN_MS = 500;
+
+int benchCsv(int megabytes) {
+    if (megabytes <= 0) megabytes = 64;
+    string cipher;
+    for (int i = 0; i < 400; i++) cipher += to_string(100000 + (i * 7919) % 150000) + " ";
+    {
+        ofstream file(CSV_BENCH_FILE, ios::binary);
+        long long written = 0, target = megabytes * 1024LL * 1024LL;
+        for (int row = 0; written < target; row++) {
+            string line = row % 4 == 3
+                ? "SUB" + to_string(row) + ",student" + to_string(row) + ",EXAM" + to_string(row % 97) + "," + cipher + ",0,123456789\n"
+                : "user" + to_string(row) + ",449620153,student,245009,5,196013,491,499,244020,1\n";
+            file << line;
+            written += line.size();
         }
     }
-    
-    if (found) {
-        drawTableBottom(6, colWidths, totalWidth);
-    } else {
-        cout << endl;
-        drawBoxTop();
-        drawBoxLine("No exams created yet", BOX_WIDTH, COLOR_INFO);
-        drawBoxBottom();
-    }
-    
-    // 2. Select Exam
-    char examId[20];
-    setColor(COLOR_INFO); cout << "\n                                                    Enter Exam ID to view responses: "; resetColor();
-    cin.getline(examId, 20);
 
-    // Verify ownership
-    int eIdx = findExam(examId);
-    int tIdx = findUser(currentUser); // Need teacher's real private key index
-    
-    if (eIdx == -1 || strcmp(exams[eIdx].teacherName, currentUser) != 0) {
-        cout << "                                                    Access Denied.\n"; pauseScreen(); return;
+    long long started = monotonicMs();
+    string buffer;
+    csvReadFile(CSV_BENCH_FILE, buffer);
+    long long readMs = max(1LL, monotonicMs() - started);
+
+    long long lines = 0, fields = 0, passes = 0;
+    started = monotonicMs();
+    long long elapsed;
+    do {
+        CsvCursor file = csvCursor(buffer);
+        string_view line, field;
+        while (csvNextLine(file, line)) {
+            lines++;
+            CsvCursor row = csvCursor(line);
+            while (csvNextField(row, field)) fields++;
+        }
+        passes++;
+        elapsed = monotonicMs() - started;
+    } while (elapsed < CSV_BENCH_MIN_MS);
+    remove(CSV_BENCH_FILE);
+
+#if defined(CSV_USE_AVX2)
+    const char* path = "AVX2";
+#elif defined(CSV_USE_SSE2)
+    const char* path = "SSE2";
+#else
+    const char* path = "scalar";
+#endif
+    char line[200];
+    sprintf(line, "csv: %d MB file read at %.0f MB/s, tokenized at %.0f MB/s (%s), %lld lines, %lld fields",
+            megabytes, megabytes * 1000.0 / readMs, passes * buffer.size() / 1048576.0 * 1000.0 / max(1LL, elapsed), path,
+            lines / passes, fields / passes);
+    cout << line << endl;
+    return 0;
+}
+
+// Row index lookups. Fills the tables with synthetic users, classes and
+// exams (rows and indexes only, nothing is saved) and times findUser(),
+// findClass() and findExam() by name, a findUser() miss, and the linear
+// strcmp scan the indexes replaced.
+const int INDEX_BENCH_CLASSES = 1000;
+const int INDEX_BENCH_MIN_MS = 200;
+const int INDEX_BENCH_SCANS = 200;
+
+int scanUsers(const char* username) {
+    for (int i = 0; i < userCount; i++) {
+        if (users.isLive(i) && strcmp(symbolName(users[i].username), username) == 0) return i;
     }
+    return -1;
+}
 
-    bool foundSub = false;
-    for (int i = 0; i < assignmentCount; i++) {
-        // Find assignments linked to this exam ID
-        if (strcmp(assignments[i].courseName, examId) == 0) {
-            foundSub = true;
-            
-            // DECRYPT ANSWER
-            // The student encrypted it with our Public Key, so we use our Private Key (d)
-            char decryptedAnswer[5000];
-           
-           decryptMessage(assignments[i].encryptedSubmission, decryptedAnswer, exams[eIdx].exam_d, exams[eIdx].exam_n);
+// Cycles find() over names until INDEX_BENCH_MIN_MS have passed, or over
+// the first limit names once. Returns nanoseconds per lookup; hits counts
+// the lookups that found a row.
+double timeLookups(int (*find)(const char*), const vector<string>& names, long long& hits, int limit = 0) {
+    long long lookups = 0, elapsed;
+    long long started = monotonicMs();
+    hits = 0;
+    do {
+        int count = limit > 0 ? min(limit, (int)names.size()) : (int)names.size();
+        for (int i = 0; i < count; i++) hits += find(names[i].c_str()) != -1;
+        lookups += count;
+        elapsed = monotonicMs() - started;
+    } while (limit == 0 && elapsed < INDEX_BENCH_MIN_MS);
+    return max(1LL, elapsed) * 1000000.0 / lookups;
+}
 
-            cout << endl;
-            drawBoxTop();
-            char header[100]; 
-            sprintf(header, "Student: %s", assignments[i].studentName);
-            drawBoxLine(header, BOX_WIDTH, COLOR_HEADER);
-            drawBoxMiddle();
-            
-            cout << "                                                     Decrypted Response :\n" << endl;
-            setColor(COLOR_SUCCESS);
-            cout << "                                                    " << decryptedAnswer << endl;
-            resetColor();
-            
-            drawBoxMiddle();
-            
-            // Signature Verification (Optional cool feature)
-            // Verify using the calculated public key E (which is mathematically valid for verification here)
-            // For simplicity, we just show the hash
-            char sigStr[100];
-            sprintf(sigStr, "Digital Sig: %lld", assignments[i].signature.signatureHash);
-            drawBoxLine(sigStr, BOX_WIDTH, COLOR_INFO);
-            
-            drawBoxBottom();
+int benchIndex(int userTotal, int examTotal) {
+    if (userTotal <= 0) userTotal = 100000;
+    if (examTotal <= 0) examTotal = 10000;
+    vector<string> userNames, missingNames, classNames, examNames;
+    char name[40];
+    RSAKeys keys = RSAKeys();
+    {
+        TableGuard guard(0, TABLE_USERS | TABLE_CLASSES | TABLE_EXAMS);
+        for (int i = 0; i < userTotal; i++) {
+            sprintf(name, "user%d", i);
+            insertUser(name, "0", "student", keys);
+            userNames.push_back(name);
+            sprintf(name, "nobody%d", i);
+            missingNames.push_back(name);
+        }
+        for (int i = 0; i < INDEX_BENCH_CLASSES; i++) {
+            int row = allocRow(classes, classCount);
+            classes[row].classId = generateId("CLS");
+            classes[row].isActive = true;
+            indexSet(classIndex, classes[row].classId, row);
+            classNames.push_back(symbolName(classes[row].classId));
+        }
+        for (int i = 0; i < examTotal; i++) {
+            int row = allocRow(exams, examCount);
+            examPayloads.ensure(row) = ExamPayload();
+            exams[row].id = generateId("EXAM");
+            exams[row].assignedClassId = classes[i % INDEX_BENCH_CLASSES].classId;
+            exams[row].isActive = true;
+            indexSet(examIndex, exams[row].id, row);
+            examNames.push_back(symbolName(exams[row].id));
         }
     }
 
-    if (!foundSub) {
-        cout << "\n                                                    No submissions received for this exam yet.\n";
+    TableGuard guard(TABLE_USERS | TABLE_CLASSES | TABLE_EXAMS, 0);
+    long long userHits, missHits, classHits, examHits, scanHits;
+    double userNs = timeLookups(findUser, userNames, userHits);
+    double missNs = timeLookups(findUser, missingNames, missHits);
+    double classNs = timeLookups(findClass, classNames, classHits);
+    double examNs = timeLookups(findExam, examNames, examHits);
+    vector<string> scanNames;
+    for (int i = 0; i < INDEX_BENCH_SCANS; i++) scanNames.push_back(userNames[(long long)i * userTotal / INDEX_BENCH_SCANS]);
+    double scanNs = timeLookups(scanUsers, scanNames, scanHits, INDEX_BENCH_SCANS);
+
+    char line[300];
+    sprintf(line, "index: %d users, %d classes, %d exams; findUser %.0f ns, missing user %.0f ns, findClass %.0f ns, "
+            "findExam %.0f ns; linear user scan %.0f ns",
+            userTotal, INDEX_BENCH_CLASSES, examTotal, userNs, missNs, classNs, examNs, scanNs);
+    cout << line << endl;
+    if (missHits != 0 || scanHits != INDEX_BENCH_SCANS) {
+        cout << "index: lookups returned wrong rows" << endl;
+        return 1;
     }
-    pauseScreen();
+    return 0;
 }
-// DASHBOARD MENUS 
-
-void teacherDashboard() {
-    while (true) {
-        clearScreen();
-        displayTeacherBanner();
-        
-        char welcomeMsg[100];
-        sprintf(welcomeMsg, "Welcome, Teacher %s", currentUser);
-        drawBoxTop();
-        drawBoxLine(welcomeMsg, BOX_WIDTH, COLOR_INFO);
-        drawBoxBottom();
 
-        cout << endl;
-        displaySectionHeader("MAIN MENU");
-        
-        // Menu Options
-        cout << endl;
-        setColor(COLOR_INFO); cout << "                                                    1. "; resetColor(); cout << "Create New Class" << endl;
-        setColor(COLOR_INFO); cout << "                                                    2. "; resetColor(); cout << "View My Classes" << endl;
-        setColor(COLOR_INFO); cout << "                                                    3. "; resetColor(); cout << "Create New Exam" << endl;
-        setColor(COLOR_INFO); cout << "                                                    4. "; resetColor(); cout << "View My Exams" << endl;
-        setColor(COLOR_INFO); cout << "                                                    5. "; resetColor(); cout << "Distribute Exam Keys" << endl;
-        setColor(COLOR_INFO); cout << "                                                    6. "; resetColor(); cout << "View Student Submissions" << endl;
-        cout << "                                                    -----------------------------" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    7. "; resetColor(); cout << "View My RSA Key Info" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    8. "; resetColor(); cout << "RSA Encryption Demo" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    9. "; resetColor(); cout << "Digital Signature Demo" << endl;
-        cout << "                                                    -----------------------------" << endl;
-        setColor(COLOR_ERROR); cout << "                                                    0. "; resetColor(); cout << "Logout" << endl;
+// Hot/cold exam layout. Fills exams[] and examPayloads[] with synthetic
+// exams, plus a copy with each payload inline in its row (the layout before
+// the split), and times the "one teacher's active exams" filter over each.
+// Rows that pass read their title, as listings do.
+const int SCAN_BENCH_TEACHERS = 100;
+const int SCAN_BENCH_MIN_MS = 500;
 
-        cout << endl;
-        drawBoxTop(BOX_WIDTH);
-        drawBoxLine("Enter your choice: ", BOX_WIDTH, COLOR_HEADER);
-        drawBoxBottom(BOX_WIDTH);
-        
-        int choice;
-        cout << "  > ";
-        cin >> choice;
-        cin.ignore();
+struct InlineExam {
+    Exam exam;
+    ExamPayload payload;
+};
 
-        switch (choice) {
-            case 1: createClass(); break;
-            case 2: viewMyClasses(); break;
-            case 3: createExam(); break;
-            case 4: viewMyExams(); break;
-            case 5: distributeExamKey(); break;
-            case 6: viewSubmissions(); break;
-            case 7: viewMyKeyInfo(); break;
-            case 8: rsaEncryptionDemo(); break;
-            case 9: digitalSignatureDemo(); break;
-            case 0: return; // Returns to main()
-            default:
-                cout << "\n  Invalid choice!";
-                cin.get();
-        }
+template <typename Row>
+long long scanPass(const Row& rowOf, int rows, Symbol teacher) {
+    long long matched = 0;
+    for (int i = 0; i < rows; i++) {
+        const Exam& e = rowOf.exam(i);
+        if (e.teacherName == teacher && e.isActive) matched += 1 + rowOf.payload(i).title[0];
     }
+    return matched;
 }
 
-void studentDashboard() {
-    while (true) {
-        clearScreen();
-        displayStudentBanner();
+struct SplitRows {
+    const Exam& exam(int i) const { return exams[i]; }
+    const ExamPayload& payload(int i) const { return examPayloads[i]; }
+};
 
-        char welcomeMsg[100];
-        sprintf(welcomeMsg, "Welcome, Student %s", currentUser);
-        drawBoxTop();
-        drawBoxLine(welcomeMsg, BOX_WIDTH, COLOR_SUCCESS);
-        drawBoxBottom();
+struct InlineRows {
+    ChunkedTable<InlineExam>* table;
+    const Exam& exam(int i) const { return (*table)[i].exam; }
+    const ExamPayload& payload(int i) const { return (*table)[i].payload; }
+};
 
-        cout << endl;
-        displaySectionHeader("MAIN MENU");
+// Scans once per teacher, in rounds, until SCAN_BENCH_MIN_MS have passed.
+// Returns milliseconds per scan; matched is what one round found.
+template <typename Row>
+double timeScans(const Row& rowOf, int rows, const vector<Symbol>& teachers, long long& matched) {
+    long long started = monotonicMs(), elapsed;
+    int rounds = 0;
+    do {
+        long long found = 0;
+        for (int t = 0; t < (int)teachers.size(); t++) found += scanPass(rowOf, rows, teachers[t]);
+        matched = found;
+        rounds++;
+        elapsed = monotonicMs() - started;
+    } while (elapsed < SCAN_BENCH_MIN_MS);
+    return (double)elapsed / (rounds * (int)teachers.size());
+}
 
-        // Menu Options
-        cout << endl;
-        setColor(COLOR_SUCCESS); cout << "                                                    1. "; resetColor(); cout << "Join a Class" << endl;
-        setColor(COLOR_SUCCESS); cout << "                                                    2. "; resetColor(); cout << "View Enrolled Classes" << endl;
-        setColor(COLOR_SUCCESS); cout << "                                                    3. "; resetColor(); cout << "View Received Exam Keys" << endl;
-        setColor(COLOR_SUCCESS); cout << "                                                    4. "; resetColor(); cout << "Attempt Exam" << endl; 
-        cout << "                                                    -----------------------------" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    5. "; resetColor(); cout << "View My RSA Key Info" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    6. "; resetColor(); cout << "RSA Encryption Demo" << endl;
-        setColor(COLOR_TITLE); cout << "                                                    7. "; resetColor(); cout << "Digital Signature Demo" << endl;
-        cout << "                                                    -----------------------------" << endl;
-        setColor(COLOR_ERROR); cout << "                                                    0. "; resetColor(); cout << "Logout" << endl;
+int benchScan(int examTotal) {
+    if (examTotal <= 0) examTotal = 200000;
+    vector<Symbol> teachers;
+    char name[40];
+    for (int t = 0; t < SCAN_BENCH_TEACHERS; t++) {
+        sprintf(name, "teacher%d", t);
+        teachers.push_back(intern(name));
+    }
+    ChunkedTable<InlineExam> inlineExams;
+    TableGuard guard(0, TABLE_EXAMS);
+    for (int i = 0; i < examTotal; i++) {
+        int row = allocRow(exams, examCount);
+        examPayloads.ensure(row) = ExamPayload();
+        exams[row].teacherName = teachers[randomNext() % teachers.size()];
+        exams[row].isActive = randomNext() % 10 != 0;
+        sprintf(examPayloads[row].title, "Exam %d", i);
+        InlineExam& copy = inlineExams.ensure(row);
+        copy.exam = exams[row];
+        copy.payload = examPayloads[row];
+    }
 
-        cout << endl;
-        drawBoxTop(BOX_WIDTH);
-        drawBoxLine("Enter your choice: ", BOX_WIDTH, COLOR_HEADER);
-        drawBoxBottom(BOX_WIDTH);
+    SplitRows split;
+    InlineRows inlined = { &inlineExams };
+    long long splitMatched, inlineMatched;
+    double splitMs = timeScans(split, examCount, teachers, splitMatched);
+    double inlineMs = timeScans(inlined, examCount, teachers, inlineMatched);
+    for (int c = 0; c < (int)inlineExams.chunks.size(); c++) delete[] inlineExams.chunks[c];
 
-        int choice;
-        cout << "  > ";
-        cin >> choice;
-        cin.ignore();
+    char line[200];
+    sprintf(line, "scan: %d exams, %d teachers; hot rows %.2f ms, inline rows %.2f ms per scan (x%.1f)",
+            examTotal, SCAN_BENCH_TEACHERS, splitMs, inlineMs, splitMs > 0 ? inlineMs / splitMs : 0.0);
+    cout << line << endl;
+    if (splitMatched != inlineMatched) {
+        cout << "scan: layouts found different rows" << endl;
+        return 1;
+    }
+    return 0;
+}
 
-        switch (choice) {
-            case 1: joinClass(); break;
-            case 2: viewMyEnrolledClasses(); break;
-            case 3: viewReceivedKeys(); break;
-            case 4: attemptExam(); break;
-            case 5: viewMyKeyInfo(); break;
-            case 6: rsaEncryptionDemo(); break;
-            case 7: digitalSignatureDemo(); break;
-            case 0: return; // Returns to main()
-            default:
-                cout << "\n  Invalid choice!";
-                cin.get();
-        }
+// Removes what the benchmark and the writer thread left in BENCH_DIR.
+void removeBenchFiles() {
+    char path[100];
+    for (int i = 0; i < classCount; i++) {
+        if (!classes.isLive(i)) continue;
+        const char* shardId = symbolName(classes[i].classId);
+        removeShardFiles(shardId);
+        sprintf(path, "%s/%s", SHARD_ROOT, shardId);
+        removeDirectory(path);
+    }
+    removeDirectory(SHARD_ROOT);
+    remove("users.txt");
+    remove("classes.txt");
+    remove("messagesList.txt");
+    remove(MESSAGE_LOG);
+    remove("requests.txt");
+}
+
+int runBenchmark(int argc, char* argv[]) {
+    makeDirectory(BENCH_DIR);
+    if (!changeDirectory(BENCH_DIR)) return 1;
+    startExecutor();
+    startPersistence();
+    startIngestion();
+    const char* name = argv[1] + strlen("--bench-");
+    int arg1 = argc >= 3 ? atoi(argv[2]) : 0;
+    int arg2 = argc >= 4 ? atoi(argv[3]) : 0;
+    int status = 0;
+    if (strcmp(name, "submit") == 0) status = benchSubmit(arg1, arg2);
+    else if (strcmp(name, "locks") == 0) status = benchLocks(arg1, arg2);
+    else if (strcmp(name, "csv") == 0) status = benchCsv(arg1);
+    else if (strcmp(name, "index") == 0) status = benchIndex(arg1, arg2);
+    else if (strcmp(name, "scan") == 0) status = benchScan(arg1);
+    else {
+        cout << "Unknown benchmark: " << argv[1] << endl;
+        status = 1;
     }
+    stopIngestion();
+    stopPersistence();
+    stopExecutor();
+    removeBenchFiles();
+    if (changeDirectory("..")) removeDirectory(BENCH_DIR);
+    return status;
 }
 
 //  MAIN FUNCTION 
 
-int main() {
+int main(int argc, char* argv[]) {
     // 1. Initialization
     srand(time(0));  // Seed random number generator
+    if (argc >= 2 && strncmp(argv[1], "--bench-", 8) == 0) return runBenchmark(argc, argv);
     loadAllData();   // Load all database files
     syncIdCounter();
+    startExecutor();
+    startPersistence();
+    startIngestion();
+    startTimers();
+    archiveInactiveRecords();
+    if (argc >= 2 && strcmp(argv[1], "--server") == 0) {
+        return runServer(argc >= 3 ? atoi(argv[2]) : DEFAULT_SERVER_PORT);
+    }
     SetConsoleTitle("Secure Exam Management System (RSA)");
 
     bool running = true;
 
     while (running) {
+        compactTables(false);
         clearScreen();
         displayMainBanner();
         
@@ -2794,6 +8027,9 @@ int main() {
         for(int i=0; i<padding; i++) cout << " ";
         setColor(COLOR_TITLE); cout << "3. RSA FEATURES DEMO" << endl;
         
+        for(int i=0; i<padding; i++) cout << " ";
+        setColor(COLOR_DEFAULT); cout << "4. SYSTEM STATISTICS" << endl;
+        
         for(int i=0; i<padding; i++) cout << " ";
         setColor(COLOR_ERROR); cout << "0. EXIT APPLICATION" << endl;
         resetColor();
@@ -2823,6 +8059,7 @@ int main() {
                     }
                     // Reset current user on logout
                     currentUser[0] = '\0';
+                    currentUserSym = NO_SYMBOL;
                     currentRole[0] = '\0';
                 }
                 break;
@@ -2845,7 +8082,7 @@ int main() {
                              pauseScreen(); 
                          } else {
                              // Use first user's keys for demo
-                             strcpy(currentUser, users[0].username); 
+                             strcpy(currentUser, symbolName(users[0].username)); 
                              rsaEncryptionDemo(); 
                              currentUser[0] = '\0';
                          }
@@ -2855,7 +8092,7 @@ int main() {
                              cout << "  [!] Please register a user first.\n"; 
                              pauseScreen(); 
                         } else {
-                            strcpy(currentUser, users[0].username);
+                            strcpy(currentUser, symbolName(users[0].username));
                             digitalSignatureDemo();
                             currentUser[0] = '\0';
                         }
@@ -2863,6 +8100,9 @@ int main() {
                     else break;
                 }
                 break;
+            case 4:
+                viewSystemStats();
+                break;
             case 0:
                 running = false;
                 break;
@@ -2878,6 +8118,10 @@ int main() {
     clearScreen();
     drawBoxTop();
     
+    stopTimers();
+    stopIngestion();
+    stopPersistence();
+    stopExecutor();
     saveAllData();
     drawBoxLine("Data Saved Successfully.", BOX_WIDTH, COLOR_SUCCESS);
     drawBoxLine("Goodbye!", BOX_WIDTH, COLOR_HEADER);